@@ -46,13 +46,22 @@
 ///@{
 #include <emergent/geometry/aabb.hpp>
 #include <emergent/geometry/bounding-volume.hpp>
+#include <emergent/geometry/bvh.hpp>
 #include <emergent/geometry/convex-hull.hpp>
+#include <emergent/geometry/culling.hpp>
+#include <emergent/geometry/fitting.hpp>
+#include <emergent/geometry/obb.hpp>
+#include <emergent/geometry/occlusion-buffer.hpp>
 #include <emergent/geometry/octree.hpp>
 #include <emergent/geometry/plane.hpp>
 #include <emergent/geometry/ray.hpp>
+#include <emergent/geometry/ray-packet.hpp>
 #include <emergent/geometry/rect.hpp>
+#include <emergent/geometry/simplification.hpp>
+#include <emergent/geometry/spatial-hash.hpp>
 #include <emergent/geometry/sphere.hpp>
 #include <emergent/geometry/split-view-frustum.hpp>
+#include <emergent/geometry/sweep-and-prune.hpp>
 #include <emergent/geometry/triangle-mesh.hpp>
 #include <emergent/geometry/view-frustum.hpp>
 ///@}
@@ -69,6 +78,7 @@
 #include <emergent/graphics/bind-pose.hpp>
 #include <emergent/graphics/bone.hpp>
 #include <emergent/graphics/camera.hpp>
+#include <emergent/graphics/gl-state.hpp>
 #include <emergent/graphics/gl3w.hpp>
 #include <emergent/graphics/light.hpp>
 #include <emergent/graphics/material.hpp>
@@ -85,6 +95,7 @@
 #include <emergent/graphics/texture-2d.hpp>
 #include <emergent/graphics/texture-cube.hpp>
 #include <emergent/graphics/texture-loader.hpp>
+#include <emergent/graphics/uniform-buffer.hpp>
 #include <emergent/graphics/vertex-format.hpp>
 ///@}
 
@@ -152,6 +163,7 @@
 #include <emergent/utility/event-dispatcher.hpp>
 #include <emergent/utility/event-handler.hpp>
 #include <emergent/utility/event.hpp>
+#include <emergent/utility/mapped-file.hpp>
 #include <emergent/utility/os-interface.hpp>
 #include <emergent/utility/parameter-dict.hpp>
 #include <emergent/utility/performance-sampler.hpp>
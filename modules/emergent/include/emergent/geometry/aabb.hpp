@@ -27,6 +27,7 @@ namespace Emergent
 {
 
 class Sphere;
+class OBB;
 
 /**
  * Axis-aligned bounding box.
@@ -48,12 +49,20 @@ public:
 	
 	void add(const Vector3& v);
 	
+	/**
+	 * Returns the smallest AABB which contains this box after an affine transformation. The bottom row of the matrix is ignored, so projective matrices are not supported.
+	 */
 	AABB transformed(const Matrix4& m) const;
+	
+	/**
+	 * Returns the smallest AABB which contains this box after a transformation.
+	 */
 	AABB transformed(const Transform& transform) const;
 	
 	virtual BoundingVolume::Type getType() const;
 	virtual bool intersects(const Sphere& sphere) const;
 	virtual bool intersects(const AABB& aabb) const;
+	virtual bool intersects(const OBB& obb) const;
 	virtual bool contains(const Vector3& point) const;
 	virtual bool contains(const Sphere& sphere) const;
 	virtual bool contains(const AABB& aabb) const;
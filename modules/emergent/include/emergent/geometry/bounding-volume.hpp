@@ -28,6 +28,7 @@ namespace Emergent
 
 class Sphere;
 class AABB;
+class OBB;
 class ConvexHull;
 
 /**
@@ -42,12 +43,14 @@ public:
 	{
 		SPHERE,
 		AABB,
+		OBB,
 		CONVEX_HULL
 	};
 	
 	virtual BoundingVolume::Type getType() const = 0;
 	virtual bool intersects(const Sphere& sphere) const = 0;
 	virtual bool intersects(const AABB& aabb) const = 0;
+	virtual bool intersects(const OBB& obb) const = 0;
 	virtual bool contains(const Sphere& sphere) const = 0;
 	virtual bool contains(const AABB& aabb) const = 0;
 	virtual bool contains(const Vector3& point) const = 0;
@@ -0,0 +1,231 @@
+/*
+ * Copyright (C) 2017-2019  Christopher J. Howard
+ *
+ * This file is part of Emergent.
+ *
+ * Emergent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Emergent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Emergent.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EMERGENT_GEOMETRY_BVH_HPP
+#define EMERGENT_GEOMETRY_BVH_HPP
+
+#include <emergent/geometry/ray-packet.hpp>
+#include <emergent/math/types.hpp>
+#include <cstdint>
+#include <cstdlib>
+#include <tuple>
+#include <vector>
+
+namespace Emergent
+{
+
+class TriangleMesh;
+
+/**
+ * Bounding volume hierarchy over the triangles of a triangle mesh.
+ *
+ * The hierarchy is built with the binned surface area heuristic and stored as a flat array of nodes in depth-first order. The triangles of each leaf are copied into contiguous packets in leaf order and tested four at a time, so traversal never touches the source mesh. A BVH only needs to be rebuilt when the vertex positions of its mesh change.
+ *
+ * As all arrays refer to each other by index, a built hierarchy can be serialized into a binary image with BVH::serialize() and later queried in place from a memory-mapped file with BVH::load(), without being rebuilt.
+ *
+ * @ingroup geometry
+ */
+class BVH
+{
+public:
+	/**
+	 * Flattened BVH node. The left child of an interior node immediately follows its parent.
+	 */
+	struct Node
+	{
+		/// Minimum point of the node bounds
+		Vector3 min;
+
+		/// Index of the first triangle packet if this is a leaf node, index of the right child otherwise
+		std::uint32_t offset;
+
+		/// Maximum point of the node bounds
+		Vector3 max;
+
+		/// Number of triangles if this is a leaf node, `0` otherwise
+		std::uint32_t count;
+	};
+
+	/// Identifies a serialized BVH image.
+	static constexpr std::uint32_t fileMagic = 0x48564245;
+
+	/// Version of the serialized BVH format. Images with any other version are rejected.
+	static constexpr std::uint32_t fileVersion = 1;
+
+	/**
+	 * Creates an empty BVH.
+	 */
+	BVH();
+
+	/**
+	 * Creates a copy of a BVH. A copy of a loaded BVH refers to the same image.
+	 */
+	BVH(const BVH& other);
+
+	/**
+	 * Creates a BVH from a triangle mesh.
+	 *
+	 * @param mesh Specifies the triangle mesh from which to build the BVH.
+	 */
+	explicit BVH(const TriangleMesh& mesh);
+
+	/**
+	 * Builds the BVH from a triangle mesh, replacing any previously built hierarchy.
+	 *
+	 * @param mesh Specifies the triangle mesh from which to build the BVH.
+	 */
+	void build(const TriangleMesh& mesh);
+
+	/**
+	 * Frees all nodes and triangles.
+	 */
+	void clear();
+
+	/**
+	 * Serializes the hierarchy into a position-independent binary image. The image consists of a header, followed by the nodes, triangle packets, and triangle indices, each aligned to 64 bytes and located by its offset from the start of the image. Values are stored in native byte order, and the header holds a CRC-32 checksum of everything which follows it.
+	 *
+	 * @param[out] data Returns the binary image.
+	 */
+	void serialize(std::vector<std::uint8_t>* data) const;
+
+	/**
+	 * Loads a hierarchy from a binary image created by BVH::serialize(), replacing any previously built hierarchy. The image is queried in place, without being copied or parsed, so it must remain valid and unmodified until the BVH is rebuilt, cleared, or destroyed. This makes it suitable for querying memory-mapped files, in which case only the pages touched by queries are read.
+	 *
+	 * @param data Specifies the image, aligned to at least 16 bytes.
+	 * @param size Specifies the size of the image, in bytes.
+	 * @param verify Specifies whether to verify the checksum of the image and the links between its nodes, which reads the entire image. Only the header is checked otherwise, so unverified images must come from a trusted source.
+	 * @throw std::runtime_error The image is misaligned, truncated, corrupt, of another version, or was serialized with another byte order.
+	 */
+	void load(const void* data, std::size_t size, bool verify = true);
+
+	/**
+	 * Finds the closest triangle intersected by a ray.
+	 *
+	 * @param ray Specifies the ray to cast.
+	 * @param tmax Specifies the maximum distance along the ray.
+	 * @return The first element in the tuple indicates whether or not an intersection occurred. The second element indicates the distance from the origin to the point of intersection. The third element is the index of the intersected triangle in the source mesh.
+	 */
+	std::tuple<bool, float, std::size_t> closestHit(const Ray& ray, float tmax) const;
+
+	/**
+	 * Checks whether a ray intersects any triangle. Traversal stops at the first intersection found, which makes this the cheapest query for occlusion and line-of-sight tests.
+	 *
+	 * @param ray Specifies the ray to cast.
+	 * @param tmax Specifies the maximum distance along the ray.
+	 * @return `true` if any triangle is intersected within `tmax`, `false` otherwise.
+	 */
+	bool anyHit(const Ray& ray, float tmax) const;
+
+	/**
+	 * Finds all triangles intersected by a ray, in no particular order.
+	 *
+	 * @param ray Specifies the ray to cast.
+	 * @param tmax Specifies the maximum distance along the ray.
+	 * @param[out] hits Returns the distance and source mesh triangle index of each intersection. Results are appended to the vector.
+	 */
+	void allHits(const Ray& ray, float tmax, std::vector<std::tuple<float, std::size_t>>* hits) const;
+
+	/**
+	 * Copies a BVH. A copy of a loaded BVH refers to the same image.
+	 */
+	BVH& operator=(const BVH& other);
+
+	/// Returns the number of nodes in the hierarchy.
+	std::size_t getNodeCount() const;
+
+	/// Returns the number of triangle packets in the hierarchy.
+	std::size_t getPacketCount() const;
+
+	/// Returns the number of triangles in the hierarchy.
+	std::size_t getTriangleCount() const;
+
+	/// Returns a pointer to the flattened nodes.
+	const BVH::Node* getNodes() const;
+
+	/// Returns a pointer to the triangle packets, in leaf order. The unused lanes of each leaf's last packet contain degenerate triangles.
+	const TrianglePacket<4>* getPackets() const;
+
+	/// Returns a pointer to the source mesh triangle index of each packet lane.
+	const std::uint32_t* getIndices() const;
+
+private:
+	/**
+	 * Points the hierarchy at its own node, packet, and index arrays.
+	 */
+	void bindArrays();
+
+	/**
+	 * Creates a node for a range of triangles and recursively subdivides it.
+	 *
+	 * @param begin Index of the first triangle in the range.
+	 * @param end Index one past the last triangle in the range.
+	 * @param depth Depth of the node being created.
+	 * @param triangleMin Minimum point of each triangle.
+	 * @param triangleMax Maximum point of each triangle.
+	 * @param centroids Centroid of each triangle.
+	 */
+	void subdivide(std::uint32_t begin, std::uint32_t end, std::size_t depth, const std::vector<Vector3>& triangleMin, const std::vector<Vector3>& triangleMax, const std::vector<Vector3>& centroids);
+
+	std::vector<BVH::Node> nodes;
+	std::vector<TrianglePacket<4>> packets;
+	std::vector<std::uint32_t> indices;
+	std::size_t triangleCount;
+
+	// Arrays which are queried, either owned by the hierarchy or within a loaded image
+	const BVH::Node* nodeData;
+	const TrianglePacket<4>* packetData;
+	const std::uint32_t* indexData;
+	std::size_t nodeCount;
+	std::size_t packetCount;
+};
+
+inline std::size_t BVH::getNodeCount() const
+{
+	return nodeCount;
+}
+
+inline std::size_t BVH::getPacketCount() const
+{
+	return packetCount;
+}
+
+inline std::size_t BVH::getTriangleCount() const
+{
+	return triangleCount;
+}
+
+inline const BVH::Node* BVH::getNodes() const
+{
+	return nodeData;
+}
+
+inline const TrianglePacket<4>* BVH::getPackets() const
+{
+	return packetData;
+}
+
+inline const std::uint32_t* BVH::getIndices() const
+{
+	return indexData;
+}
+
+} // namespace Emergent
+
+#endif // EMERGENT_GEOMETRY_BVH_HPP
+
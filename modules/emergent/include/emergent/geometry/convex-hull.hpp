@@ -29,17 +29,26 @@ namespace Emergent
 
 class Sphere;
 class AABB;
+class OBB;
 
 /**
- * Convex hull defined by a collection of planes
+ * Convex hull defined by a collection of planes. Planes are stored inline, so hulls never allocate and can be copied freely.
  *
  * @ingroup geometry
  */
 class ConvexHull: public BoundingVolume
 {
 public:
+	/// Maximum number of planes in a convex hull
+	static constexpr std::size_t maxPlaneCount = 16;
+	
+	/**
+	 * Creates a convex hull.
+	 *
+	 * @param planeCount Number of planes in the hull, which must not exceed ConvexHull::maxPlaneCount.
+	 * @throw std::runtime_error Plane count exceeds ConvexHull::maxPlaneCount.
+	 */
 	explicit ConvexHull(std::size_t planeCount);
-	~ConvexHull();
 	
 	void setPlane(std::size_t index, const Plane& plane);
 	
@@ -49,12 +58,13 @@ public:
 	virtual BoundingVolume::Type getType() const;
 	virtual bool intersects(const Sphere& sphere) const;
 	virtual bool intersects(const AABB& aabb) const;
+	virtual bool intersects(const OBB& obb) const;
 	virtual bool contains(const Vector3& point) const;
 	virtual bool contains(const Sphere& sphere) const;
 	virtual bool contains(const AABB& aabb) const;
 	
 private:
-	Plane* planes;
+	Plane planes[maxPlaneCount];
 	std::size_t planeCount;
 };
 
@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2017-2019  Christopher J. Howard
+ *
+ * This file is part of Emergent.
+ *
+ * Emergent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Emergent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Emergent.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EMERGENT_GEOMETRY_CULLING_HPP
+#define EMERGENT_GEOMETRY_CULLING_HPP
+
+#include <cstdint>
+#include <cstdlib>
+#include <emergent/math/types.hpp>
+
+namespace Emergent
+{
+
+class ConvexHull;
+
+/**
+ * Tests a batch of axis-aligned bounding boxes against a convex hull, such as a view frustum. The result for each box is identical to that of ConvexHull::intersects(const AABB&) const, but boxes are stored as structure-of-arrays and tested several at a time using SIMD instructions where available.
+ *
+ * @param hull Convex hull against which to test the boxes.
+ * @param count Number of boxes.
+ * @param minX Array of `count` minimum x-coordinates.
+ * @param minY Array of `count` minimum y-coordinates.
+ * @param minZ Array of `count` minimum z-coordinates.
+ * @param maxX Array of `count` maximum x-coordinates.
+ * @param maxY Array of `count` maximum y-coordinates.
+ * @param maxZ Array of `count` maximum z-coordinates.
+ * @param[out] visibility Array of `(count + 31) / 32` words. Bit `i % 32` of word `i / 32` is set if box `i` intersects the hull, and cleared otherwise.
+ *
+ * @ingroup geometry
+ */
+void cullAABBs(const ConvexHull& hull, std::size_t count, const float* minX, const float* minY, const float* minZ, const float* maxX, const float* maxY, const float* maxZ, std::uint32_t* visibility);
+
+/**
+ * Transforms a batch of axis-aligned bounding boxes by a common affine matrix, such as the bounds of a model's groups into world space. The result for each box is identical to that of AABB::transformed(const Matrix4&) const, but boxes are stored as structure-of-arrays and transformed several at a time using SIMD instructions where available. The result arrays may alias the corresponding input arrays.
+ *
+ * @param matrix Affine transformation matrix. The bottom row is ignored.
+ * @param count Number of boxes.
+ * @param minX Array of `count` minimum x-coordinates.
+ * @param minY Array of `count` minimum y-coordinates.
+ * @param minZ Array of `count` minimum z-coordinates.
+ * @param maxX Array of `count` maximum x-coordinates.
+ * @param maxY Array of `count` maximum y-coordinates.
+ * @param maxZ Array of `count` maximum z-coordinates.
+ * @param[out] resultMinX Array of `count` transformed minimum x-coordinates.
+ * @param[out] resultMinY Array of `count` transformed minimum y-coordinates.
+ * @param[out] resultMinZ Array of `count` transformed minimum z-coordinates.
+ * @param[out] resultMaxX Array of `count` transformed maximum x-coordinates.
+ * @param[out] resultMaxY Array of `count` transformed maximum y-coordinates.
+ * @param[out] resultMaxZ Array of `count` transformed maximum z-coordinates.
+ *
+ * @ingroup geometry
+ */
+void transformAABBs(const Matrix4& matrix, std::size_t count, const float* minX, const float* minY, const float* minZ, const float* maxX, const float* maxY, const float* maxZ, float* resultMinX, float* resultMinY, float* resultMinZ, float* resultMaxX, float* resultMaxY, float* resultMaxZ);
+
+} // namespace Emergent
+
+#endif // EMERGENT_GEOMETRY_CULLING_HPP
+
@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2017-2019  Christopher J. Howard
+ *
+ * This file is part of Emergent.
+ *
+ * Emergent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Emergent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Emergent.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef EMERGENT_GEOMETRY_FITTING_HPP
+#define EMERGENT_GEOMETRY_FITTING_HPP
+
+#include <emergent/geometry/obb.hpp>
+#include <emergent/geometry/sphere.hpp>
+#include <emergent/math/types.hpp>
+#include <cstdlib>
+
+namespace Emergent
+{
+
+class TriangleMesh;
+
+/**
+ * Finds the minimal bounding sphere of a set of points, using Welzl's algorithm in expected linear time. Points are visited in a fixed pseudorandom order, so the result is deterministic.
+ *
+ * @param count Number of points.
+ * @param points Array of `count` points.
+ * @return Smallest sphere which contains all points, or a sphere of radius `0` at the origin if there are no points.
+ *
+ * @ingroup geometry
+ */
+Sphere fitSphere(std::size_t count, const Vector3* points);
+
+/**
+ * Finds the minimal bounding sphere of the vertices of a triangle mesh.
+ *
+ * @see fitSphere(std::size_t, const Vector3*)
+ *
+ * @ingroup geometry
+ */
+Sphere fitSphere(const TriangleMesh& mesh);
+
+/**
+ * Fits an oriented bounding box to a set of points. The box axes are the principal axes of the point covariance matrix, unless the axis-aligned bounding box of the points has a smaller volume, in which case it is returned instead.
+ *
+ * @param count Number of points.
+ * @param points Array of `count` points.
+ * @return Box which contains all points, or an empty box at the origin if there are no points.
+ *
+ * @ingroup geometry
+ */
+OBB fitOBB(std::size_t count, const Vector3* points);
+
+/**
+ * Fits an oriented bounding box to the vertices of a triangle mesh.
+ *
+ * @see fitOBB(std::size_t, const Vector3*)
+ *
+ * @ingroup geometry
+ */
+OBB fitOBB(const TriangleMesh& mesh);
+
+} // namespace Emergent
+
+#endif // EMERGENT_GEOMETRY_FITTING_HPP
+
@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2017-2019  Christopher J. Howard
+ *
+ * This file is part of Emergent.
+ *
+ * Emergent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Emergent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Emergent.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef EMERGENT_GEOMETRY_OBB_HPP
+#define EMERGENT_GEOMETRY_OBB_HPP
+
+#include <emergent/geometry/bounding-volume.hpp>
+#include <emergent/math/types.hpp>
+
+namespace Emergent
+{
+
+class Sphere;
+class AABB;
+
+/**
+ * Oriented bounding box, defined by a center, three orthonormal axes, and the half-extents of the box along each axis.
+ *
+ * @ingroup geometry
+ */
+class OBB: public BoundingVolume
+{
+public:
+	OBB() = default;
+	OBB(const Vector3& center, const Matrix3& axes, const Vector3& extents);
+	
+	/// Creates an OBB which is identical to an AABB.
+	explicit OBB(const AABB& aabb);
+	
+	void setCenter(const Vector3& center);
+	void setAxes(const Matrix3& axes);
+	void setExtents(const Vector3& extents);
+	
+	const Vector3& getCenter() const;
+	
+	/// Returns the axes of the box, one per column.
+	const Matrix3& getAxes() const;
+	
+	/// Returns the half-extents of the box along each axis.
+	const Vector3& getExtents() const;
+	
+	/// Returns the smallest AABB which contains this box.
+	AABB getBounds() const;
+	
+	/**
+	 * Transforms this box. Rotations and uniform scales are applied exactly. Under a non-uniform scale the transformed box is no longer rectangular, so the result is the smallest box with the same first two axis directions which contains it.
+	 */
+	OBB transformed(const Transform& transform) const;
+	
+	virtual BoundingVolume::Type getType() const;
+	virtual bool intersects(const Sphere& sphere) const;
+	virtual bool intersects(const AABB& aabb) const;
+	virtual bool intersects(const OBB& obb) const;
+	virtual bool contains(const Vector3& point) const;
+	virtual bool contains(const Sphere& sphere) const;
+	virtual bool contains(const AABB& aabb) const;
+	
+private:
+	Vector3 center;
+	Matrix3 axes;
+	Vector3 extents;
+};
+
+inline OBB::OBB(const Vector3& center, const Matrix3& axes, const Vector3& extents):
+	center(center),
+	axes(axes),
+	extents(extents)
+{}
+
+inline void OBB::setCenter(const Vector3& center)
+{
+	this->center = center;
+}
+
+inline void OBB::setAxes(const Matrix3& axes)
+{
+	this->axes = axes;
+}
+
+inline void OBB::setExtents(const Vector3& extents)
+{
+	this->extents = extents;
+}
+
+inline const Vector3& OBB::getCenter() const
+{
+	return center;
+}
+
+inline const Matrix3& OBB::getAxes() const
+{
+	return axes;
+}
+
+inline const Vector3& OBB::getExtents() const
+{
+	return extents;
+}
+
+inline BoundingVolume::Type OBB::getType() const
+{
+	return BoundingVolume::Type::OBB;
+}
+
+} // namespace Emergent
+
+#endif // EMERGENT_GEOMETRY_OBB_HPP
+
@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) 2017-2019  Christopher J. Howard
+ *
+ * This file is part of Emergent.
+ *
+ * Emergent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Emergent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Emergent.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef EMERGENT_GEOMETRY_OCCLUSION_BUFFER_HPP
+#define EMERGENT_GEOMETRY_OCCLUSION_BUFFER_HPP
+
+#include <emergent/geometry/aabb.hpp>
+#include <emergent/math/types.hpp>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+namespace Emergent
+{
+
+class TriangleMesh;
+
+/**
+ * Low-resolution software depth buffer for occlusion culling.
+ *
+ * Occluder triangles are rasterized into the buffer on the CPU, and the screen-space bounds of other objects are then tested against it to find objects which are entirely hidden. The buffer is divided into tiles of 8x4 pixels, each of which stores the farthest depth of its pixels. Whole tiles are skipped by both rasterization and testing when their farthest depth already decides the outcome, and the pixels of a tile row are processed several at a time using SIMD instructions where available.
+ *
+ * Pixels are covered by a triangle if their centers lie inside it, but the depth written to each covered pixel is the farthest depth of the triangle's plane over the pixel, so that occluders never appear nearer than they are. Occluders crossing the near clipping plane are ignored. As coverage is sampled, the silhouettes of occluders may extend up to half a pixel beyond their true extents, so boxes are tested against their screen-space rectangles dilated by one pixel.
+ *
+ * Depths are normalized device depths in the range `[0, 1]`, as produced by an OpenGL projection matrix.
+ *
+ * @ingroup geometry
+ */
+class OcclusionBuffer
+{
+public:
+	/// Width of a tile, in pixels.
+	static constexpr int tileWidth = 8;
+
+	/// Height of a tile, in pixels.
+	static constexpr int tileHeight = 4;
+
+	/**
+	 * Creates an empty occlusion buffer with no pixels.
+	 */
+	OcclusionBuffer();
+
+	/**
+	 * Creates an occlusion buffer.
+	 *
+	 * @param width Width of the buffer, in pixels.
+	 * @param height Height of the buffer, in pixels.
+	 */
+	OcclusionBuffer(int width, int height);
+
+	/**
+	 * Changes the resolution of the buffer and clears it.
+	 *
+	 * @param width Width of the buffer, in pixels.
+	 * @param height Height of the buffer, in pixels.
+	 */
+	void resize(int width, int height);
+
+	/**
+	 * Removes all occluders from the buffer and sets the view-projection matrix of subsequent rasterization and testing.
+	 *
+	 * @param viewProjection Matrix which transforms world space into clip space.
+	 */
+	void clear(const Matrix4& viewProjection);
+
+	/**
+	 * Rasterizes occluder triangles into the buffer.
+	 *
+	 * @param transform Matrix which transforms the positions into world space.
+	 * @param vertexCount Number of vertices.
+	 * @param positions Array of `vertexCount` vertex positions.
+	 * @param triangleCount Number of triangles.
+	 * @param indices Array of `triangleCount * 3` vertex indices.
+	 */
+	void rasterize(const Matrix4& transform, std::size_t vertexCount, const Vector3* positions, std::size_t triangleCount, const std::uint32_t* indices);
+
+	/**
+	 * Rasterizes the triangles of an occluder mesh into the buffer.
+	 *
+	 * @param transform Matrix which transforms the mesh into world space.
+	 * @param mesh Occluder mesh.
+	 */
+	void rasterize(const Matrix4& transform, const TriangleMesh& mesh);
+
+	/**
+	 * Tests whether any part of a box may be visible past the occluders in the buffer.
+	 *
+	 * @param bounds World-space bounds of the box.
+	 * @return `false` if the box is entirely hidden behind occluders, `true` otherwise. Boxes which cross the near clipping plane or lie outside the buffer are always considered visible.
+	 */
+	bool isVisible(const AABB& bounds) const;
+
+	/// Returns the width of the buffer, in pixels.
+	int getWidth() const;
+
+	/// Returns the height of the buffer, in pixels.
+	int getHeight() const;
+
+	/**
+	 * Returns the depth of a pixel, or infinity if no occluder covers the pixel.
+	 *
+	 * @param x Column of the pixel, from the left.
+	 * @param y Row of the pixel, from the bottom.
+	 */
+	float getDepth(int x, int y) const;
+
+private:
+	/// Vertex of an occluder triangle in screen space.
+	struct ScreenVertex
+	{
+		float x;
+		float y;
+		float depth;
+		bool clipped;
+	};
+
+	/// Transforms a vertex position into screen space.
+	ScreenVertex project(const Matrix4& matrix, const Vector3& position) const;
+
+	/// Rasterizes a single screen-space triangle.
+	void rasterize(const ScreenVertex& v0, const ScreenVertex& v1, const ScreenVertex& v2);
+
+	/// Recalculates the farthest depth of a tile.
+	void updateTileDepth(std::size_t tile);
+
+	/// Returns the index of the first pixel of a tile.
+	std::size_t getTileOffset(int tileX, int tileY) const;
+
+	int width;
+	int height;
+	int tileColumns;
+	int tileRows;
+	Matrix4 viewProjection;
+	std::vector<float> depths;
+	std::vector<float> tileDepths;
+	std::vector<ScreenVertex> screenVertices;
+};
+
+inline int OcclusionBuffer::getWidth() const
+{
+	return width;
+}
+
+inline int OcclusionBuffer::getHeight() const
+{
+	return height;
+}
+
+inline std::size_t OcclusionBuffer::getTileOffset(int tileX, int tileY) const
+{
+	return (static_cast<std::size_t>(tileY) * tileColumns + tileX) * (tileWidth * tileHeight);
+}
+
+} // namespace Emergent
+
+#endif // EMERGENT_GEOMETRY_OCCLUSION_BUFFER_HPP
+
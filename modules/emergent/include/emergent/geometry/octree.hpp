@@ -20,14 +20,21 @@
 #ifndef EMERGENT_GEOMETRY_OCTREE_HPP
 #define EMERGENT_GEOMETRY_OCTREE_HPP
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <cstdlib>
+#include <limits>
 #include <list>
-#include <utility>
+#include <tuple>
+#include <vector>
 
 #include <emergent/math/types.hpp>
 #include <emergent/geometry/aabb.hpp>
 #include <emergent/geometry/bounding-volume.hpp>
+#include <emergent/geometry/convex-hull.hpp>
 #include <emergent/geometry/ray.hpp>
+#include <emergent/geometry/ray-packet.hpp>
 
 namespace Emergent
 {
@@ -35,7 +42,9 @@ namespace Emergent
 /**
  * An octree.
  *
- * Total number of nodes in the octree can be calculated by `(((2^maxDepth)^3) - 1) / 7`.
+ * Octants are allocated on demand from a contiguous node pool, so memory usage scales with the number of occupied cells rather than with `8^maxDepth`.
+ *
+ * Inserted entries are referred to by handles, which allow moving entries to be removed or updated without rebuilding the octree.
  *
  * @tparam T Specifies the entry type.
  *
@@ -48,6 +57,12 @@ public:
 	/// Specifies the entry type.
 	typedef T EntryType;
 
+	/// Specifies the type of handle which refers to an inserted entry.
+	typedef std::uint32_t HandleType;
+
+	/// Handle which is returned when an entry could not be inserted.
+	static constexpr HandleType invalidHandle = std::numeric_limits<HandleType>::max();
+
 	/**
 	 * Creates an instance of Octree.
 	 *
@@ -69,7 +84,7 @@ public:
 	~Octree();
 	
 	/**
-	 * Resizes the octree.
+	 * Resizes the octree. Entries which are no longer contained by their octants are moved to the octants which contain them. Entries which can not be contained by the new bounds are kept in the root node.
 	 *
 	 * @param bounds New bounds of the octree.
 	 */
@@ -80,12 +95,38 @@ public:
 	 *
 	 * @param volume Specifies the bounding volume of the entry.
 	 * @param entry Specifeis the entry data.
-	 * @return `true` if the entry was successfully inserted, `false` if the entry volume could not be contained by this octree.
+	 * @return Handle to the inserted entry, or Octree::invalidHandle if the entry volume could not be contained by this octree.
+	 */
+	HandleType insert(const AABB& volume, const EntryType& entry);
+
+	/**
+	 * Inserts a batch of entries into the octree. The result is equivalent to inserting each entry in order with Octree::insert(const AABB&, const EntryType&), but the octant path of each entry is packed into a key, the keys are radix sorted, and octants are allocated in a single depth-first pass rather than by descending from the root for each entry.
+	 *
+	 * @param count Specifies the number of entries.
+	 * @param volumes Specifies an array of `count` entry bounding volumes.
+	 * @param entries Specifies an array of `count` entries.
+	 * @param[out] handles Returns an array of `count` handles, with Octree::invalidHandle for each entry whose volume could not be contained by this octree. May be `nullptr`.
+	 */
+	void insert(std::size_t count, const AABB* volumes, const EntryType* entries, HandleType* handles);
+
+	/**
+	 * Removes an entry from the octree. The handle becomes invalid and may be reused by a subsequent insertion.
+	 *
+	 * @param handle Specifies the handle of a previously inserted entry.
+	 */
+	void remove(HandleType handle);
+
+	/**
+	 * Updates the bounding volume of an entry. The entry is only moved to another octant if the new volume is no longer contained by its current octant.
+	 *
+	 * @param handle Specifies the handle of a previously inserted entry.
+	 * @param volume Specifies the new bounding volume of the entry.
+	 * @return `true` if the entry was successfully updated, `false` if the new volume could not be contained by this octree, in which case the entry is left unchanged.
 	 */
-	bool insert(const AABB& volume, const EntryType& entry);
+	bool update(HandleType handle, const AABB& volume);
 
 	/**
-	 * Removes all entries from this octree.
+	 * Removes all entries from this octree and collapses all octants.
 	 */
 	void clear();
 
@@ -105,6 +146,22 @@ public:
 	 */
 	void query(const BoundingVolume& volume, std::list<EntryType>* results) const;
 	
+	/**
+	 * Queries the octree for a list of entries within the specified convex hull, such as a view frustum. See Octree::visit(const ConvexHull&, F) const.
+	 *
+	 * @param hull Specifies the convex hull to query.
+	 * @return List of entries intersected by the specified convex hull.
+	 */
+	std::list<EntryType> query(const ConvexHull& hull) const;
+
+	/**
+	 * Queries the octree for a list of entries within the specified convex hull, such as a view frustum. See Octree::visit(const ConvexHull&, F) const.
+	 *
+	 * @param hull Specifies the convex hull to query.
+	 * @param[out] results Returns a list of entries intersected by the specified convex hull.
+	 */
+	void query(const ConvexHull& hull, std::list<EntryType>* results) const;
+	
 	/**
 	 * Queries the octree for a list of entries whose bounding volumes are intersected by the specified ray.
 	 *
@@ -122,14 +179,91 @@ public:
 	void query(const Ray& ray, std::list<EntryType>* results) const;
 
 	/**
-	 * Returns the bounds of this octree.
+	 * Queries the octree for a vector of entries within the specified volume. Results are appended to the vector, so reusing a vector between queries avoids allocations once its capacity is sufficient.
+	 *
+	 * @param volume Specifies the volume to query.
+	 * @param[out] results Returns a vector of entries intersected by the specified volume.
 	 */
-	const AABB& getBounds() const;
+	void query(const BoundingVolume& volume, std::vector<EntryType>* results) const;
 
 	/**
-	 * Returns the depth of this octree.
+	 * Queries the octree for a vector of entries within the specified convex hull, such as a view frustum. Results are appended to the vector.
+	 *
+	 * @param hull Specifies the convex hull to query.
+	 * @param[out] results Returns a vector of entries intersected by the specified convex hull.
+	 */
+	void query(const ConvexHull& hull, std::vector<EntryType>* results) const;
+
+	/**
+	 * Queries the octree for a vector of entries whose bounding volumes are intersected by the specified ray. Results are appended to the vector.
+	 *
+	 * @param ray Specifies the ray to query.
+	 * @param[out] results Returns a vector of entries intersected by the specified ray.
+	 */
+	void query(const Ray& ray, std::vector<EntryType>* results) const;
+
+	/**
+	 * Finds the entries whose bounding volumes are nearest to a point. Octants are visited best-first in order of their distance to the point, and the search stops once the nearest remaining octant is farther than the farthest of the `count` nearest entries found so far.
+	 *
+	 * @param point Specifies the point to which distances are measured.
+	 * @param count Specifies the maximum number of entries to find.
+	 * @param[out] results Returns the distance from the point to the bounding volume of each entry found, which is `0` for volumes that contain the point, along with the entry, in order of increasing distance. Results are appended to the vector.
+	 */
+	void nearest(const Vector3& point, std::size_t count, std::vector<std::tuple<float, EntryType>>* results) const;
+
+	/**
+	 * Finds all entries whose bounding volumes are within a distance of a point. Octants are visited best-first, as in Octree::nearest().
+	 *
+	 * @param point Specifies the point to which distances are measured.
+	 * @param radius Specifies the maximum distance from the point. Nothing is found if the radius is negative or NaN.
+	 * @param[out] results Returns the distance from the point to the bounding volume of each entry found, along with the entry, in order of increasing distance. Results are appended to the vector.
+	 */
+	void within(const Vector3& point, float radius, std::vector<std::tuple<float, EntryType>>* results) const;
+
+	/**
+	 * Calls a function object for each entry within the specified volume. No memory is allocated during the traversal.
+	 *
+	 * @param volume Specifies the volume to query.
+	 * @param visitor Function object with the signature `void(const EntryType&)`.
+	 */
+	template <typename F>
+	void visit(const BoundingVolume& volume, F visitor) const;
+
+	/**
+	 * Calls a function object for each entry within the specified convex hull, such as a view frustum. Results are identical to those of a query with the hull as a generic bounding volume, but a mask of active planes is carried down the tree. Planes which fully contain an octant are not tested against its descendants, and octants fully contained by all planes are accepted without further tests. Entries of the root node, which may exceed its bounds after a resize, are always tested against every plane.
+	 *
+	 * @param hull Specifies the convex hull to query.
+	 * @param visitor Function object with the signature `void(const EntryType&)`.
+	 */
+	template <typename F>
+	void visit(const ConvexHull& hull, F visitor) const;
+
+	/**
+	 * Calls a function object for each entry whose bounding volume is intersected by the specified ray. No memory is allocated during the traversal.
+	 *
+	 * @param ray Specifies the ray to query.
+	 * @param visitor Function object with the signature `void(const EntryType&)`.
 	 */
-	std::size_t getDepth() const;
+	template <typename F>
+	void visit(const Ray& ray, F visitor) const;
+
+	/**
+	 * Casts a ray through the octree, visiting octants in front-to-back order of their ray entry distances. Entries within a single octant are visited in arbitrary order.
+	 *
+	 * The hit-test function object is called for each entry whose bounding volume is intersected by the ray within `[0, tmax]`, along with the distance at which the ray enters the entry volume. It may perform a precise intersection test and shrink `tmax` to the distance of a confirmed hit, which culls all farther octants and entries. Returning `false` terminates the traversal immediately.
+	 *
+	 * @param ray Specifies the ray to cast.
+	 * @param tmax Specifies the maximum distance along the ray.
+	 * @param hitTest Function object with the signature `bool(const EntryType& entry, float t, float* tmax)`.
+	 * @return `false` if the traversal was terminated by the hit-test function object, `true` otherwise.
+	 */
+	template <typename F>
+	bool raycast(const Ray& ray, float tmax, F hitTest) const;
+
+	/**
+	 * Returns the bounds of this octree.
+	 */
+	const AABB& getBounds() const;
 
 	/**
 	 * Returns the maximum depth of this octree.
@@ -137,187 +271,529 @@ public:
 	std::size_t getMaxDepth() const;
 
 	/**
-	 * Returns a pointer to the specified octant.
-	 *
-	 * @param index Specifies the index of an octant.
+	 * Returns the number of allocated nodes in this octree, including the root node.
 	 */
-	const Octree* getOctant(std::size_t index) const;
+	std::size_t getNodeCount() const;
 
-	/// @copydoc Octree::getOctant(std::size_t) const
-	Octree* getOctant(std::size_t index);
+	/**
+	 * Returns the number of entries in this octree.
+	 */
+	std::size_t getEntryCount() const;
 	
 private:
 	/**
-	 * Creates an instance of Octree.
+	 * Entry stored in a node, along with its bounding volume and handle.
+	 */
+	struct Item
+	{
+		AABB volume;
+		EntryType entry;
+		HandleType handle;
+	};
+
+	/**
+	 * Single octant in the node pool. An octant index of `0` indicates an unallocated octant, as the root node can never be a child of another node.
+	 */
+	struct Node
+	{
+		AABB bounds;
+		std::uint32_t depth;
+		std::uint32_t octants[8];
+		std::vector<Item> items;
+	};
+
+	/**
+	 * Location of an entry within the node pool.
+	 */
+	struct Location
+	{
+		std::uint32_t node;
+		std::uint32_t position;
+	};
+
+	/**
+	 * Calculates the bounds of an octant.
+	 *
+	 * @param bounds Specifies the bounds of the parent node.
+	 * @param index Specifies the index of the octant.
+	 */
+	static AABB getOctantBounds(const AABB& bounds, std::size_t index);
+
+	/**
+	 * Allocates a node from the node pool.
+	 *
+	 * @return Index of the allocated node.
+	 */
+	std::uint32_t allocateNode(const AABB& bounds, std::uint32_t depth);
+
+	/**
+	 * Calculates the sort key of the deepest node which can contain the specified volume, without allocating any octants. The octant indices along the path from the root occupy three bits per level, most significant first and left-aligned to the maximum depth, followed by the depth of the node in the lowest five bits, so that sorted keys list nodes in depth-first order.
+	 */
+	std::uint64_t calculateKey(const AABB& volume) const;
+
+	/**
+	 * Sorts keys and their associated values with an LSD radix sort, which preserves the order of equal keys.
+	 *
+	 * @param keys Specifies the keys to sort.
+	 * @param values Specifies the values to sort along with the keys.
+	 * @param bits Specifies the number of low bits which are used by the keys.
+	 */
+	static void sortKeys(std::vector<std::uint64_t>* keys, std::vector<std::uint32_t>* values, std::size_t bits);
+
+	/**
+	 * Descends from the root node to the deepest node which can contain the specified volume, allocating octants as necessary.
 	 *
-	 * @param bounds Specifies the bounds of this octree.
-	 * @param depth Specifies the depth of this octree.
-	 * @param maxDepth Specifies the max depth of the root octree.
+	 * @return Index of the node which should contain the volume.
 	 */
-	Octree(std::size_t depth, std::size_t maxDepth, const AABB& bounds);
+	std::uint32_t descend(const AABB& volume);
+
+	/**
+	 * Appends an entry to a node and records its location.
+	 */
+	void attach(std::uint32_t index, HandleType handle, const AABB& volume, const EntryType& entry);
+
+	/**
+	 * Removes an entry from its node by swapping it with the last entry of the node.
+	 */
+	void detach(HandleType handle);
+
+	/**
+	 * Returns the squared distance from a point to the nearest point of a box, which is `0` if the box contains the point.
+	 */
+	static float distanceSquared(const AABB& box, const Vector3& point);
+
+	/**
+	 * Finds up to `count` entries whose bounding volumes are within a squared distance of a point, best-first.
+	 */
+	void nearest(const Vector3& point, std::size_t count, float maxDistanceSquared, std::vector<std::tuple<float, EntryType>>* results) const;
+
+	/**
+	 * Tests a ray against up to four consecutive entry volumes of a node.
+	 *
+	 * @param node Specifies the node containing the entries.
+	 * @param first Specifies the index of the first entry to test.
+	 * @param ray Specifies the ray to cast.
+	 * @param tmax Specifies the maximum distance along the ray.
+	 * @param[out] t Returns the ray entry distance of each tested volume.
+	 * @return Bit mask of the intersected entries, relative to `first`.
+	 */
+	static std::uint32_t intersectEntries(const Node& node, std::size_t first, const Ray& ray, float tmax, float* t);
+
+	void resize(std::uint32_t index, const AABB& bounds);
+
+	template <typename F>
+	void visit(std::uint32_t index, const BoundingVolume& volume, F& visitor) const;
+
+	template <typename F>
+	void visit(std::uint32_t index, const ConvexHull& hull, std::uint32_t planeMask, F& visitor) const;
+
+	template <typename F>
+	void visit(std::uint32_t index, const Ray& ray, F& visitor) const;
+
+	/// Visits all entries in a subtree without performing any intersection tests.
+	template <typename F>
+	void visit(std::uint32_t index, F& visitor) const;
+
+	template <typename F>
+	bool raycast(std::uint32_t index, const Ray& ray, float* tmax, F& hitTest) const;
 	
-	std::size_t depth;
 	std::size_t maxDepth;
-	AABB bounds;
-	Octree* octants[8];
-	std::list<std::pair<AABB, EntryType>> entries;
+	std::vector<Node> nodes;
+	std::vector<Location> locations;
+	std::vector<HandleType> freeHandles;
 };
 
 template <typename T>
 Octree<T>::Octree(std::size_t maxDepth, const AABB& bounds):
-	Octree(0, maxDepth, bounds)
-{}
+	maxDepth(maxDepth)
+{
+	allocateNode(bounds, 0);
+}
 
 template <typename T>
 Octree<T>::Octree(std::size_t maxDepth):
-	Octree(AABB(Vector3(0.0f), Vector3(0.0f)), 0, maxDepth)
+	Octree(maxDepth, AABB(Vector3(0.0f), Vector3(0.0f)))
 {}
 
 template <typename T>
-Octree<T>::Octree(std::size_t depth, std::size_t maxDepth, const AABB& bounds):
-	depth(depth),
-	maxDepth(maxDepth),
-	bounds(bounds)
+Octree<T>::~Octree()
+{}
+
+template <typename T>
+void Octree<T>::resize(const AABB& bounds)
 {
-	octants[0] = nullptr;
-	octants[1] = nullptr;
-	octants[2] = nullptr;
-	octants[3] = nullptr;
-	octants[4] = nullptr;
-	octants[5] = nullptr;
-	octants[6] = nullptr;
-	octants[7] = nullptr;
+	resize(0, bounds);
 
-	if (depth < maxDepth)
+	// Find entries which are no longer contained by their octants
+	std::vector<HandleType> misplaced;
+	for (const Node& node: nodes)
 	{
-		const Vector3& min = bounds.getMin();
-		const Vector3& max = bounds.getMax();
-		const Vector3 center = (min + max) * float(0.5);
+		for (const Item& item: node.items)
+		{
+			if (!node.bounds.contains(item.volume))
+			{
+				misplaced.push_back(item.handle);
+			}
+		}
+	}
 
-		const AABB octantBounds[8] =
+	// Move them to the octants which contain them, or to the root node if the new bounds can not contain them
+	for (HandleType handle: misplaced)
+	{
+		const Location location = locations[handle];
+		const Item item = nodes[location.node].items[location.position];
+		detach(handle);
+		attach((nodes[0].bounds.contains(item.volume)) ? descend(item.volume) : 0, handle, item.volume, item.entry);
+	}
+}
+
+template <typename T>
+void Octree<T>::resize(std::uint32_t index, const AABB& bounds)
+{
+	nodes[index].bounds = bounds;
+	
+	for (std::size_t i = 0; i < 8; ++i)
+	{
+		// Skip unallocated octants
+		if (nodes[index].octants[i])
 		{
-			AABB(min, center),
-			AABB({center.x, min.y, min.z}, {max.x, center.y, center.z}),
-			AABB({min.x, min.y, center.z}, {center.x, center.y, max.z}),
-			AABB({center.x, min.y, center.z}, {max.x, center.y, max.z}),
-			AABB({min.x, center.y, min.z}, {center.x, max.y, center.z}),
-			AABB({center.x, center.y, min.z}, {max.x, max.y, center.z}),
-			AABB({min.x, center.y, center.z}, {center.x, max.y, max.z}),
-			AABB(center, max)
-		};
+			resize(nodes[index].octants[i], getOctantBounds(bounds, i));
+		}
+	}
+}
 
-		std::size_t octantDepth = depth + 1;
+template <typename T>
+typename Octree<T>::HandleType Octree<T>::insert(const AABB& volume, const EntryType& entry)
+{
+	// Check if the volume can be contained within this octree
+	if (!nodes[0].bounds.contains(volume))
+	{
+		return invalidHandle;
+	}
 
-		octants[0] = new Octree(octantDepth, maxDepth, octantBounds[0]);
-		octants[1] = new Octree(octantDepth, maxDepth, octantBounds[1]);
-		octants[2] = new Octree(octantDepth, maxDepth, octantBounds[2]);
-		octants[3] = new Octree(octantDepth, maxDepth, octantBounds[3]);
-		octants[4] = new Octree(octantDepth, maxDepth, octantBounds[4]);
-		octants[5] = new Octree(octantDepth, maxDepth, octantBounds[5]);
-		octants[6] = new Octree(octantDepth, maxDepth, octantBounds[6]);
-		octants[7] = new Octree(octantDepth, maxDepth, octantBounds[7]);
+	// Allocate a handle, reusing handles of removed entries where possible
+	HandleType handle;
+	if (!freeHandles.empty())
+	{
+		handle = freeHandles.back();
+		freeHandles.pop_back();
 	}
+	else
+	{
+		handle = static_cast<HandleType>(locations.size());
+		locations.emplace_back();
+	}
+
+	attach(descend(volume), handle, volume, entry);
+
+	return handle;
 }
 
 template <typename T>
-void Octree<T>::resize(const AABB& bounds)
+void Octree<T>::insert(std::size_t count, const AABB* volumes, const EntryType* entries, HandleType* handles)
 {
-	this->bounds = bounds;
-	
-	if (depth < maxDepth)
+	// Keys hold three bits per level and five bits of depth, so deeper octrees fall back to individual insertions
+	if (maxDepth > 19)
+	{
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			HandleType handle = insert(volumes[i], entries[i]);
+			if (handles)
+				handles[i] = handle;
+		}
+		return;
+	}
+
+	// Allocate handles in input order and calculate the key of each contained entry
+	std::vector<std::uint64_t> keys;
+	std::vector<std::uint32_t> sources;
+	std::vector<HandleType> entryHandles(count);
+	keys.reserve(count);
+	sources.reserve(count);
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		if (!nodes[0].bounds.contains(volumes[i]))
+		{
+			if (handles)
+				handles[i] = invalidHandle;
+			continue;
+		}
+
+		HandleType handle;
+		if (!freeHandles.empty())
+		{
+			handle = freeHandles.back();
+			freeHandles.pop_back();
+		}
+		else
+		{
+			handle = static_cast<HandleType>(locations.size());
+			locations.emplace_back();
+		}
+
+		if (handles)
+			handles[i] = handle;
+		entryHandles[i] = handle;
+
+		keys.push_back(calculateKey(volumes[i]));
+		sources.push_back(static_cast<std::uint32_t>(i));
+	}
+
+	// Sort entries by key, so that the entries of each node are contiguous and nodes are in depth-first order
+	sortKeys(&keys, &sources, maxDepth * 3 + 5);
+
+	// Walk the sorted keys, keeping the path from the root to the current node on a stack
+	std::uint32_t stack[20];
+	stack[0] = 0;
+	std::size_t stackDepth = 0;
+	std::uint64_t previousPath = 0;
+
+	for (std::size_t i = 0; i < keys.size();)
+	{
+		const std::uint64_t key = keys[i];
+		const std::size_t depth = static_cast<std::size_t>(key & 31);
+		const std::uint64_t path = key >> 5;
+
+		// Find the end of the run of entries in the same node
+		std::size_t end = i + 1;
+		while (end < keys.size() && keys[end] == key)
+			++end;
+
+		// Keep the part of the stack which is shared with the path of the previous node
+		std::size_t shared = 0;
+		while (shared < depth && shared < stackDepth && ((path ^ previousPath) >> (3 * (maxDepth - 1 - shared)) & 7) == 0)
+			++shared;
+
+		// Descend to the node, allocating octants as necessary
+		for (std::size_t level = shared; level < depth; ++level)
+		{
+			const std::uint32_t parent = stack[level];
+			const std::size_t octant = static_cast<std::size_t>((path >> (3 * (maxDepth - 1 - level))) & 7);
+			if (!nodes[parent].octants[octant])
+			{
+				// Copy node bounds, as allocating an octant may reallocate the node pool
+				const AABB bounds = nodes[parent].bounds;
+				std::uint32_t child = allocateNode(getOctantBounds(bounds, octant), static_cast<std::uint32_t>(level + 1));
+				nodes[parent].octants[octant] = child;
+			}
+			stack[level + 1] = nodes[parent].octants[octant];
+		}
+		stackDepth = depth;
+		previousPath = path;
+
+		// Attach the run of entries to the node
+		const std::uint32_t index = stack[depth];
+		Node& node = nodes[index];
+		node.items.reserve(node.items.size() + (end - i));
+		for (; i < end; ++i)
+		{
+			const std::uint32_t source = sources[i];
+			attach(index, entryHandles[source], volumes[source], entries[source]);
+		}
+	}
+}
+
+template <typename T>
+std::uint64_t Octree<T>::calculateKey(const AABB& volume) const
+{
+	const Vector3& volumeMin = volume.getMin();
+	const Vector3& volumeMax = volume.getMax();
+	Vector3 min = nodes[0].bounds.getMin();
+	Vector3 max = nodes[0].bounds.getMax();
+
+	std::uint64_t path = 0;
+	std::size_t depth = 0;
+	while (depth < maxDepth)
 	{
-		const Vector3& min = bounds.getMin();
-		const Vector3& max = bounds.getMax();
 		const Vector3 center = (min + max) * float(0.5);
 
-		const AABB octantBounds[8] =
+		// Volumes which straddle a splitting plane can not be contained by an octant. The comparisons are combined without branching, as octant selection is unpredictable.
+		const bool straddleX = (volumeMin.x < center.x) & (volumeMax.x > center.x);
+		const bool straddleY = (volumeMin.y < center.y) & (volumeMax.y > center.y);
+		const bool straddleZ = (volumeMin.z < center.z) & (volumeMax.z > center.z);
+		if (straddleX | straddleY | straddleZ)
+			break;
+
+		// Determine which octant contains the volume, and narrow the bounds to it exactly as Octree::getOctantBounds() does
+		const bool x = volumeMax.x > center.x;
+		const bool y = volumeMax.y > center.y;
+		const bool z = volumeMax.z > center.z;
+		min.x = x ? center.x : min.x;
+		max.x = x ? max.x : center.x;
+		min.y = y ? center.y : min.y;
+		max.y = y ? max.y : center.y;
+		min.z = z ? center.z : min.z;
+		max.z = z ? max.z : center.z;
+
+		const std::uint64_t octant = static_cast<std::uint64_t>(x) | (static_cast<std::uint64_t>(z) << 1) | (static_cast<std::uint64_t>(y) << 2);
+		path |= octant << (3 * (maxDepth - 1 - depth));
+		++depth;
+	}
+
+	return (path << 5) | depth;
+}
+
+template <typename T>
+void Octree<T>::sortKeys(std::vector<std::uint64_t>* keys, std::vector<std::uint32_t>* values, std::size_t bits)
+{
+	if (keys->empty())
+		return;
+
+	std::vector<std::uint64_t> sortedKeys(keys->size());
+	std::vector<std::uint32_t> sortedValues(values->size());
+
+	for (std::size_t shift = 0; shift < bits; shift += 8)
+	{
+		// Count the occurrences of each digit
+		std::size_t offsets[256] = {};
+		for (std::uint64_t key: *keys)
+			++offsets[(key >> shift) & 255];
+
+		// Skip passes in which all keys share the same digit
+		if (offsets[((*keys)[0] >> shift) & 255] == keys->size())
+			continue;
+
+		// Convert counts to offsets and scatter keys by digit
+		std::size_t offset = 0;
+		for (std::size_t i = 0; i < 256; ++i)
+		{
+			std::size_t count = offsets[i];
+			offsets[i] = offset;
+			offset += count;
+		}
+		for (std::size_t i = 0; i < keys->size(); ++i)
 		{
-			AABB(min, center),
-			AABB({center.x, min.y, min.z}, {max.x, center.y, center.z}),
-			AABB({min.x, min.y, center.z}, {center.x, center.y, max.z}),
-			AABB({center.x, min.y, center.z}, {max.x, center.y, max.z}),
-			AABB({min.x, center.y, min.z}, {center.x, max.y, center.z}),
-			AABB({center.x, center.y, min.z}, {max.x, max.y, center.z}),
-			AABB({min.x, center.y, center.z}, {center.x, max.y, max.z}),
-			AABB(center, max)
-		};
-		
-		octants[0]->resize(octantBounds[0]);
-		octants[1]->resize(octantBounds[1]);
-		octants[2]->resize(octantBounds[2]);
-		octants[3]->resize(octantBounds[3]);
-		octants[4]->resize(octantBounds[4]);
-		octants[5]->resize(octantBounds[5]);
-		octants[6]->resize(octantBounds[6]);
-		octants[7]->resize(octantBounds[7]);
+			std::size_t j = offsets[((*keys)[i] >> shift) & 255]++;
+			sortedKeys[j] = (*keys)[i];
+			sortedValues[j] = (*values)[i];
+		}
+
+		keys->swap(sortedKeys);
+		values->swap(sortedValues);
 	}
 }
 
 template <typename T>
-Octree<T>::~Octree()
+void Octree<T>::remove(HandleType handle)
 {
-	delete octants[0];
-	delete octants[1];
-	delete octants[2];
-	delete octants[3];
-	delete octants[4];
-	delete octants[5];
-	delete octants[6];
-	delete octants[7];
+	detach(handle);
+	freeHandles.push_back(handle);
 }
 
 template <typename T>
-bool Octree<T>::insert(const AABB& volume, const EntryType& entry)
+bool Octree<T>::update(HandleType handle, const AABB& volume)
 {
+	const Location location = locations[handle];
+	Node& node = nodes[location.node];
+
+	// Entry remains within its current octant, update volume in place
+	if (node.bounds.contains(volume))
+	{
+		node.items[location.position].volume = volume;
+		return true;
+	}
+
 	// Check if the volume can be contained within this octree
-	if (!bounds.contains(volume))
+	if (!nodes[0].bounds.contains(volume))
 	{
 		return false;
 	}
 
-	if (depth < maxDepth)
+	// Move entry to the octant which contains its new volume
+	EntryType entry = node.items[location.position].entry;
+	detach(handle);
+	attach(descend(volume), handle, volume, entry);
+
+	return true;
+}
+
+template <typename T>
+std::uint32_t Octree<T>::descend(const AABB& volume)
+{
+	const Vector3& volumeMin = volume.getMin();
+	const Vector3& volumeMax = volume.getMax();
+
+	std::uint32_t index = 0;
+	while (nodes[index].depth < maxDepth)
 	{
-		// Check if the volume can be contained within an octant
-		if (octants[0]->insert(volume, entry))
-			return true;
-		if (octants[1]->insert(volume, entry))
-			return true;
-		if (octants[2]->insert(volume, entry))
-			return true;
-		if (octants[3]->insert(volume, entry))
-			return true;
-		if (octants[4]->insert(volume, entry))
-			return true;
-		if (octants[5]->insert(volume, entry))
-			return true;
-		if (octants[6]->insert(volume, entry))
-			return true;
-		if (octants[7]->insert(volume, entry))
-			return true;
+		// Copy node bounds, as allocating an octant may reallocate the node pool
+		const AABB bounds = nodes[index].bounds;
+		const Vector3 center = (bounds.getMin() + bounds.getMax()) * float(0.5);
+
+		// Volumes which straddle a splitting plane can not be contained by an octant
+		if (volumeMin.x < center.x && volumeMax.x > center.x)
+			break;
+		if (volumeMin.y < center.y && volumeMax.y > center.y)
+			break;
+		if (volumeMin.z < center.z && volumeMax.z > center.z)
+			break;
+
+		// Determine which octant contains the volume
+		std::size_t octant = 0;
+		if (volumeMax.x > center.x)
+			octant |= 1;
+		if (volumeMax.z > center.z)
+			octant |= 2;
+		if (volumeMax.y > center.y)
+			octant |= 4;
+
+		// Allocate octant on demand
+		if (!nodes[index].octants[octant])
+		{
+			std::uint32_t child = allocateNode(getOctantBounds(bounds, octant), nodes[index].depth + 1);
+			nodes[index].octants[octant] = child;
+		}
+
+		index = nodes[index].octants[octant];
 	}
 
-	// Volume could not be contained by octants, add entry to this quadtree
-	entries.push_back(std::make_pair(volume, entry));
+	return index;
+}
 
-	return true;
+template <typename T>
+void Octree<T>::attach(std::uint32_t index, HandleType handle, const AABB& volume, const EntryType& entry)
+{
+	Node& node = nodes[index];
+
+	locations[handle].node = index;
+	locations[handle].position = static_cast<std::uint32_t>(node.items.size());
+
+	node.items.push_back({volume, entry, handle});
 }
 
 template <typename T>
-void Octree<T>::clear()
+void Octree<T>::detach(HandleType handle)
 {
-	entries.clear();
+	const Location location = locations[handle];
+	Node& node = nodes[location.node];
 
-	if (depth < maxDepth)
+	// Move the last entry of the node into the vacated position
+	const std::uint32_t last = static_cast<std::uint32_t>(node.items.size() - 1);
+	if (location.position != last)
 	{
-		octants[0]->clear();
-		octants[1]->clear();
-		octants[2]->clear();
-		octants[3]->clear();
-		octants[4]->clear();
-		octants[5]->clear();
-		octants[6]->clear();
-		octants[7]->clear();
+		node.items[location.position] = node.items[last];
+		locations[node.items[last].handle].position = location.position;
 	}
+
+	node.items.pop_back();
+}
+
+template <typename T>
+void Octree<T>::clear()
+{
+	// Collapse all octants into the root node
+	nodes.erase(nodes.begin() + 1, nodes.end());
+	
+	Node& root = nodes[0];
+	root.items.clear();
+	for (std::size_t i = 0; i < 8; ++i)
+	{
+		root.octants[i] = 0;
+	}
+
+	// Invalidate all handles
+	locations.clear();
+	freeHandles.clear();
 }
 
 template <typename T>
@@ -333,95 +809,495 @@ std::list<typename Octree<T>::EntryType> Octree<T>::query(const BoundingVolume&
 template <typename T>
 void Octree<T>::query(const BoundingVolume& volume, std::list<EntryType>* results) const
 {
-	// Check if the volume intersects with this quadtree
-	if (!volume.intersects(bounds))
+	visit(volume, [results](const EntryType& entry) { results->push_back(entry); });
+}
+
+template <typename T>
+void Octree<T>::query(const BoundingVolume& volume, std::vector<EntryType>* results) const
+{
+	visit(volume, [results](const EntryType& entry) { results->push_back(entry); });
+}
+
+template <typename T>
+std::list<typename Octree<T>::EntryType> Octree<T>::query(const ConvexHull& hull) const
+{
+	std::list<EntryType> results;
+	query(hull, &results);
+	return results;
+}
+
+template <typename T>
+void Octree<T>::query(const ConvexHull& hull, std::list<EntryType>* results) const
+{
+	visit(hull, [results](const EntryType& entry) { results->push_back(entry); });
+}
+
+template <typename T>
+void Octree<T>::query(const ConvexHull& hull, std::vector<EntryType>* results) const
+{
+	visit(hull, [results](const EntryType& entry) { results->push_back(entry); });
+}
+
+template <typename T>
+std::list<typename Octree<T>::EntryType> Octree<T>::query(const Ray& ray) const
+{
+	std::list<EntryType> results;
+
+	query(ray, &results);
+
+	return results;
+}
+
+template <typename T>
+void Octree<T>::query(const Ray& ray, std::list<EntryType>* results) const
+{
+	visit(ray, [results](const EntryType& entry) { results->push_back(entry); });
+}
+
+template <typename T>
+void Octree<T>::query(const Ray& ray, std::vector<EntryType>* results) const
+{
+	visit(ray, [results](const EntryType& entry) { results->push_back(entry); });
+}
+
+template <typename T>
+void Octree<T>::nearest(const Vector3& point, std::size_t count, std::vector<std::tuple<float, EntryType>>* results) const
+{
+	nearest(point, count, std::numeric_limits<float>::infinity(), results);
+}
+
+template <typename T>
+void Octree<T>::within(const Vector3& point, float radius, std::vector<std::tuple<float, EntryType>>* results) const
+{
+	// Reject negative and NaN radii before squaring, which would turn a negative radius into a positive one
+	if (!(radius >= 0.0f))
+		return;
+
+	nearest(point, std::numeric_limits<std::size_t>::max(), radius * radius, results);
+}
+
+template <typename T>
+void Octree<T>::nearest(const Vector3& point, std::size_t count, float maxDistanceSquared, std::vector<std::tuple<float, EntryType>>* results) const
+{
+	if (!count)
+		return;
+
+	// Results found so far are kept in a max-heap of squared distances at the end of the results vector, so the farthest can be replaced
+	const std::size_t first = results->size();
+	auto farther = [](const std::tuple<float, EntryType>& lhs, const std::tuple<float, EntryType>& rhs)
+	{
+		return std::get<0>(lhs) < std::get<0>(rhs);
+	};
+
+	// Octants waiting to be visited are kept in a min-heap of squared distances
+	typedef std::tuple<float, std::uint32_t> Candidate;
+	auto nearer = [](const Candidate& lhs, const Candidate& rhs)
+	{
+		return std::get<0>(lhs) > std::get<0>(rhs);
+	};
+	std::vector<Candidate> candidates;
+	candidates.emplace_back(distanceSquared(nodes[0].bounds, point), 0);
+
+	// Once enough results have been found, the search is limited to the distance of the farthest result
+	auto getLimit = [&]()
+	{
+		return (results->size() - first == count) ? std::get<0>((*results)[first]) : maxDistanceSquared;
+	};
+
+	while (!candidates.empty())
+	{
+		std::pop_heap(candidates.begin(), candidates.end(), nearer);
+		const Candidate candidate = candidates.back();
+		candidates.pop_back();
+
+		// All remaining octants are farther than the limit
+		if (std::get<0>(candidate) > getLimit())
+			break;
+
+		const Node& node = nodes[std::get<1>(candidate)];
+		for (const Item& item: node.items)
+		{
+			const float distance = distanceSquared(item.volume, point);
+			if (distance > maxDistanceSquared)
+				continue;
+
+			if (results->size() - first < count)
+			{
+				results->emplace_back(distance, item.entry);
+				std::push_heap(results->begin() + first, results->end(), farther);
+			}
+			else if (distance < std::get<0>((*results)[first]))
+			{
+				std::pop_heap(results->begin() + first, results->end(), farther);
+				results->back() = std::make_tuple(distance, item.entry);
+				std::push_heap(results->begin() + first, results->end(), farther);
+			}
+		}
+
+		const float limit = getLimit();
+		for (std::size_t i = 0; i < 8; ++i)
+		{
+			if (!node.octants[i])
+				continue;
+
+			const float distance = distanceSquared(nodes[node.octants[i]].bounds, point);
+			if (distance <= limit)
+			{
+				candidates.emplace_back(distance, node.octants[i]);
+				std::push_heap(candidates.begin(), candidates.end(), nearer);
+			}
+		}
+	}
+
+	// Sort results by distance and convert squared distances to distances
+	std::sort_heap(results->begin() + first, results->end(), farther);
+	for (std::size_t i = first; i < results->size(); ++i)
+	{
+		std::get<0>((*results)[i]) = std::sqrt(std::get<0>((*results)[i]));
+	}
+}
+
+template <typename T>
+inline float Octree<T>::distanceSquared(const AABB& box, const Vector3& point)
+{
+	const Vector3 difference = glm::max(glm::max(box.getMin() - point, point - box.getMax()), Vector3(0.0f));
+	return glm::dot(difference, difference);
+}
+
+template <typename T>
+template <typename F>
+void Octree<T>::visit(const BoundingVolume& volume, F visitor) const
+{
+	visit(0, volume, visitor);
+}
+
+template <typename T>
+template <typename F>
+void Octree<T>::visit(std::uint32_t index, const BoundingVolume& volume, F& visitor) const
+{
+	const Node& node = nodes[index];
+
+	// Check if the volume intersects with this node
+	if (!volume.intersects(node.bounds))
 		return;
 
 	// Perform intersection tests for individual entries
-	for (auto it = entries.begin(); it != entries.end(); ++it)
+	for (const Item& item: node.items)
 	{
-		if (volume.intersects(it->first))
+		if (volume.intersects(item.volume))
 		{
-			results->push_back(it->second);
+			visitor(item.entry);
 		}
 	}
 
-	if (depth < maxDepth)
+	// Visit allocated octants
+	for (std::size_t i = 0; i < 8; ++i)
 	{
-		// Query octants
-		octants[0]->query(volume, results);
-		octants[1]->query(volume, results);
-		octants[2]->query(volume, results);
-		octants[3]->query(volume, results);
-		octants[4]->query(volume, results);
-		octants[5]->query(volume, results);
-		octants[6]->query(volume, results);
-		octants[7]->query(volume, results);
+		if (node.octants[i])
+		{
+			visit(node.octants[i], volume, visitor);
+		}
 	}
 }
 
 template <typename T>
-std::list<typename Octree<T>::EntryType> Octree<T>::query(const Ray& ray) const
+template <typename F>
+void Octree<T>::visit(const ConvexHull& hull, F visitor) const
 {
-	std::list<EntryType> results;
+	visit(0, hull, (1u << hull.getPlaneCount()) - 1, visitor);
+}
 
-	query(ray, &results);
+template <typename T>
+template <typename F>
+void Octree<T>::visit(std::uint32_t index, const ConvexHull& hull, std::uint32_t planeMask, F& visitor) const
+{
+	const Node& node = nodes[index];
+	const Vector3& min = node.bounds.getMin();
+	const Vector3& max = node.bounds.getMax();
 
-	return results;
+	// Test this node against each active plane
+	std::uint32_t nodeMask = planeMask;
+	for (std::size_t i = 0; i < hull.getPlaneCount(); ++i)
+	{
+		if (!((planeMask >> i) & 1))
+			continue;
+
+		const Plane& plane = hull.getPlane(i);
+		const Vector3& normal = plane.getNormal();
+
+		// Reject the node if its vertex farthest along the plane normal is outside the plane
+		Vector3 pv;
+		pv.x = (normal.x > 0.0f) ? max.x : min.x;
+		pv.y = (normal.y > 0.0f) ? max.y : min.y;
+		pv.z = (normal.z > 0.0f) ? max.z : min.z;
+		if (plane.distance(pv) < 0.0f)
+			return;
+
+		// Deactivate the plane if the node's nearest vertex is also inside it
+		Vector3 nv;
+		nv.x = (normal.x > 0.0f) ? min.x : max.x;
+		nv.y = (normal.y > 0.0f) ? min.y : max.y;
+		nv.z = (normal.z > 0.0f) ? min.z : max.z;
+		if (plane.distance(nv) >= 0.0f)
+			nodeMask &= ~(1u << i);
+	}
+
+	if (!nodeMask && index)
+	{
+		// Accept the entire subtree
+		visit(index, visitor);
+		return;
+	}
+
+	// Perform intersection tests for individual entries against the active planes. Entries are contained by their node, so they are inside all inactive planes, except for entries of the root node, which may exceed its bounds after a resize.
+	const std::uint32_t entryMask = (index) ? nodeMask : planeMask;
+	for (const Item& item: node.items)
+	{
+		const Vector3& volumeMin = item.volume.getMin();
+		const Vector3& volumeMax = item.volume.getMax();
+
+		bool inside = true;
+		for (std::size_t j = 0; j < hull.getPlaneCount(); ++j)
+		{
+			if (!((entryMask >> j) & 1))
+				continue;
+
+			const Plane& plane = hull.getPlane(j);
+			const Vector3& normal = plane.getNormal();
+
+			Vector3 pv;
+			pv.x = (normal.x > 0.0f) ? volumeMax.x : volumeMin.x;
+			pv.y = (normal.y > 0.0f) ? volumeMax.y : volumeMin.y;
+			pv.z = (normal.z > 0.0f) ? volumeMax.z : volumeMin.z;
+			if (plane.distance(pv) < 0.0f)
+			{
+				inside = false;
+				break;
+			}
+		}
+
+		if (inside)
+		{
+			visitor(item.entry);
+		}
+	}
+
+	// Visit allocated octants
+	for (std::size_t i = 0; i < 8; ++i)
+	{
+		if (node.octants[i])
+		{
+			visit(node.octants[i], hull, nodeMask, visitor);
+		}
+	}
 }
 
 template <typename T>
-void Octree<T>::query(const Ray& ray, std::list<EntryType>* results) const
+template <typename F>
+void Octree<T>::visit(std::uint32_t index, F& visitor) const
 {
-	// Check if the ray intersects with this quadtree
-	if (!std::get<0>(ray.intersects(bounds)))
+	const Node& node = nodes[index];
+
+	for (const Item& item: node.items)
+	{
+		visitor(item.entry);
+	}
+
+	for (std::size_t i = 0; i < 8; ++i)
+	{
+		if (node.octants[i])
+		{
+			visit(node.octants[i], visitor);
+		}
+	}
+}
+
+template <typename T>
+template <typename F>
+void Octree<T>::visit(const Ray& ray, F visitor) const
+{
+	visit(0, ray, visitor);
+}
+
+template <typename T>
+template <typename F>
+void Octree<T>::visit(std::uint32_t index, const Ray& ray, F& visitor) const
+{
+	const Node& node = nodes[index];
+
+	// Check if the ray intersects with this node
+	if (!std::get<0>(ray.intersects(node.bounds)))
 		return;
 
-	// Perform intersection tests for individual entries
-	for (auto it = entries.begin(); it != entries.end(); ++it)
+	// Perform intersection tests for individual entries, four at a time
+	for (std::size_t i = 0; i < node.items.size(); i += 4)
 	{
-		if (std::get<0>(ray.intersects(it->first)))
+		float t[4];
+		std::uint32_t mask = intersectEntries(node, i, ray, std::numeric_limits<float>::infinity(), t);
+		for (std::size_t j = 0; mask; ++j, mask >>= 1)
 		{
-			results->push_back(it->second);
+			if (mask & 1)
+			{
+				visitor(node.items[i + j].entry);
+			}
 		}
 	}
 	
-	if (depth < maxDepth)
+	// Visit allocated octants
+	for (std::size_t i = 0; i < 8; ++i)
 	{
-		// Query octants
-		octants[0]->query(ray, results);
-		octants[1]->query(ray, results);
-		octants[2]->query(ray, results);
-		octants[3]->query(ray, results);
-		octants[4]->query(ray, results);
-		octants[5]->query(ray, results);
-		octants[6]->query(ray, results);
-		octants[7]->query(ray, results);
+		if (node.octants[i])
+		{
+			visit(node.octants[i], ray, visitor);
+		}
 	}
 }
 
 template <typename T>
-inline const Octree<T>* Octree<T>::getOctant(std::size_t index) const
+template <typename F>
+bool Octree<T>::raycast(const Ray& ray, float tmax, F hitTest) const
 {
-	return octants[index];
+	// Check if the ray intersects with the root node within the maximum distance
+	auto intersection = ray.intersects(nodes[0].bounds);
+	if (!std::get<0>(intersection) || std::get<1>(intersection) > tmax)
+		return true;
+
+	return raycast(0, ray, &tmax, hitTest);
 }
 
 template <typename T>
-inline Octree<T>* Octree<T>::getOctant(std::size_t index)
+template <typename F>
+bool Octree<T>::raycast(std::uint32_t index, const Ray& ray, float* tmax, F& hitTest) const
 {
-	return octants[index];
+	const Node& node = nodes[index];
+
+	// Perform intersection tests for individual entries, four at a time
+	for (std::size_t i = 0; i < node.items.size(); i += 4)
+	{
+		float t[4];
+		std::uint32_t mask = intersectEntries(node, i, ray, *tmax, t);
+		for (std::size_t j = 0; mask; ++j, mask >>= 1)
+		{
+			// The hit test may have reduced the maximum distance
+			if (mask & 1 && t[j] <= *tmax && !hitTest(node.items[i + j].entry, t[j], tmax))
+			{
+				return false;
+			}
+		}
+	}
+
+	// Test all allocated octants at once
+	AABBPacket<8> packet;
+	for (std::size_t i = 0; i < 8; ++i)
+	{
+		if (node.octants[i])
+			packet.set(i, nodes[node.octants[i]].bounds);
+		else
+			packet.clear(i);
+	}
+	float octantDistances[8];
+	std::uint32_t mask = intersects(ray, packet, *tmax, octantDistances);
+
+	// Sort intersected octants by their ray entry distances
+	std::uint32_t octants[8];
+	float distances[8];
+	std::size_t octantCount = 0;
+	for (std::size_t i = 0; i < 8; ++i)
+	{
+		if (!((mask >> i) & 1))
+			continue;
+
+		float t = octantDistances[i];
+		std::size_t j = octantCount++;
+		for (; j > 0 && distances[j - 1] > t; --j)
+		{
+			octants[j] = octants[j - 1];
+			distances[j] = distances[j - 1];
+		}
+		octants[j] = node.octants[i];
+		distances[j] = t;
+	}
+
+	// Traverse octants front-to-back
+	for (std::size_t i = 0; i < octantCount; ++i)
+	{
+		// All remaining octants lie beyond the closest hit
+		if (distances[i] > *tmax)
+			break;
+
+		if (!raycast(octants[i], ray, tmax, hitTest))
+		{
+			return false;
+		}
+	}
+
+	return true;
 }
 
 template <typename T>
-inline const AABB& Octree<T>::getBounds() const
+std::uint32_t Octree<T>::intersectEntries(const Node& node, std::size_t first, const Ray& ray, float tmax, float* t)
 {
-	return bounds;
+	AABBPacket<4> packet;
+	for (std::size_t i = 0; i < 4; ++i)
+	{
+		if (first + i < node.items.size())
+			packet.set(i, node.items[first + i].volume);
+		else
+			packet.clear(i);
+	}
+
+	return intersects(ray, packet, tmax, t);
+}
+
+template <typename T>
+AABB Octree<T>::getOctantBounds(const AABB& bounds, std::size_t index)
+{
+	const Vector3& min = bounds.getMin();
+	const Vector3& max = bounds.getMax();
+	const Vector3 center = (min + max) * float(0.5);
+
+	switch (index)
+	{
+		case 0:
+			return AABB(min, center);
+		case 1:
+			return AABB({center.x, min.y, min.z}, {max.x, center.y, center.z});
+		case 2:
+			return AABB({min.x, min.y, center.z}, {center.x, center.y, max.z});
+		case 3:
+			return AABB({center.x, min.y, center.z}, {max.x, center.y, max.z});
+		case 4:
+			return AABB({min.x, center.y, min.z}, {center.x, max.y, center.z});
+		case 5:
+			return AABB({center.x, center.y, min.z}, {max.x, max.y, center.z});
+		case 6:
+			return AABB({min.x, center.y, center.z}, {center.x, max.y, max.z});
+		default:
+			return AABB(center, max);
+	}
 }
 
 template <typename T>
-inline std::size_t Octree<T>::getDepth() const
+std::uint32_t Octree<T>::allocateNode(const AABB& bounds, std::uint32_t depth)
 {
-	return depth;
+	std::uint32_t index = static_cast<std::uint32_t>(nodes.size());
+	nodes.emplace_back();
+	
+	Node& node = nodes.back();
+	node.bounds = bounds;
+	node.depth = depth;
+	for (std::size_t i = 0; i < 8; ++i)
+	{
+		node.octants[i] = 0;
+	}
+
+	return index;
+}
+
+template <typename T>
+inline const AABB& Octree<T>::getBounds() const
+{
+	return nodes[0].bounds;
 }
 
 template <typename T>
@@ -430,6 +1306,18 @@ inline std::size_t Octree<T>::getMaxDepth() const
 	return maxDepth;
 }
 
+template <typename T>
+inline std::size_t Octree<T>::getNodeCount() const
+{
+	return nodes.size();
+}
+
+template <typename T>
+inline std::size_t Octree<T>::getEntryCount() const
+{
+	return locations.size() - freeHandles.size();
+}
+
 } // namespace Emergent
 
 #endif // EMERGENT_GEOMETRY_OCTREE_HPP
@@ -0,0 +1,271 @@
+/*
+ * Copyright (C) 2017-2019  Christopher J. Howard
+ *
+ * This file is part of Emergent.
+ *
+ * Emergent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Emergent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Emergent.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EMERGENT_GEOMETRY_RAY_PACKET_HPP
+#define EMERGENT_GEOMETRY_RAY_PACKET_HPP
+
+#include <emergent/geometry/aabb.hpp>
+#include <emergent/geometry/ray.hpp>
+#include <emergent/math/types.hpp>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+
+namespace Emergent
+{
+
+/**
+ * Structure-of-arrays batch of rays, which can be tested against a single primitive at once.
+ *
+ * @tparam N Number of rays in the packet, either `4` or `8`.
+ *
+ * @ingroup geometry
+ */
+template <std::size_t N>
+struct alignas(N * sizeof(float)) RayPacket
+{
+	/// Number of rays in the packet
+	static constexpr std::size_t width = N;
+
+	/**
+	 * Sets a ray in the packet.
+	 *
+	 * @param lane Index of the ray within the packet.
+	 * @param ray Ray to store.
+	 * @param tmax Maximum distance along the ray.
+	 */
+	void set(std::size_t lane, const Ray& ray, float tmax);
+
+	/**
+	 * Disables a ray in the packet, such that it will never report an intersection.
+	 *
+	 * @param lane Index of the ray within the packet.
+	 */
+	void clear(std::size_t lane);
+
+	float originX[N];
+	float originY[N];
+	float originZ[N];
+	float directionX[N];
+	float directionY[N];
+	float directionZ[N];
+	float inverseDirectionX[N];
+	float inverseDirectionY[N];
+	float inverseDirectionZ[N];
+	float tmax[N];
+};
+
+/**
+ * Structure-of-arrays batch of triangles, which can be tested against a single ray at once. Each triangle is stored as its first vertex and two edge vectors.
+ *
+ * @tparam N Number of triangles in the packet, either `4` or `8`.
+ *
+ * @ingroup geometry
+ */
+template <std::size_t N>
+struct alignas(N * sizeof(float)) TrianglePacket
+{
+	/// Number of triangles in the packet
+	static constexpr std::size_t width = N;
+
+	/**
+	 * Sets a triangle in the packet.
+	 *
+	 * @param lane Index of the triangle within the packet.
+	 * @param a First vertex in the triangle.
+	 * @param b Second vertex in the triangle.
+	 * @param c Third vertex in the triangle.
+	 */
+	void set(std::size_t lane, const Vector3& a, const Vector3& b, const Vector3& c);
+
+	/**
+	 * Replaces a triangle in the packet with a degenerate triangle, which will never report an intersection.
+	 *
+	 * @param lane Index of the triangle within the packet.
+	 */
+	void clear(std::size_t lane);
+
+	float ax[N];
+	float ay[N];
+	float az[N];
+	float edge10x[N];
+	float edge10y[N];
+	float edge10z[N];
+	float edge20x[N];
+	float edge20y[N];
+	float edge20z[N];
+};
+
+/**
+ * Structure-of-arrays batch of axis-aligned bounding boxes, which can be tested against a single ray at once.
+ *
+ * @tparam N Number of boxes in the packet, either `4` or `8`.
+ *
+ * @ingroup geometry
+ */
+template <std::size_t N>
+struct alignas(N * sizeof(float)) AABBPacket
+{
+	/// Number of boxes in the packet
+	static constexpr std::size_t width = N;
+
+	/**
+	 * Sets a box in the packet.
+	 *
+	 * @param lane Index of the box within the packet.
+	 * @param aabb Box to store.
+	 */
+	void set(std::size_t lane, const AABB& aabb);
+
+	/**
+	 * Replaces a box in the packet with an inverted box, which will never report an intersection.
+	 *
+	 * @param lane Index of the box within the packet.
+	 */
+	void clear(std::size_t lane);
+
+	float minX[N];
+	float minY[N];
+	float minZ[N];
+	float maxX[N];
+	float maxY[N];
+	float maxZ[N];
+};
+
+/**
+ * Checks for intersection between a ray and a packet of triangles. Uses the same Möller–Trumbore formulation as Ray::intersects(const Vector3&, const Vector3&, const Vector3&) const.
+ *
+ * @param ray Ray with which to check for intersection.
+ * @param triangles Packet of triangles.
+ * @param tmax Maximum distance along the ray.
+ * @param[out] t Array of `N` distances from the ray origin to the points of intersection. Only elements whose bit is set in the returned mask are meaningful.
+ * @return Bit mask in which bit `i` is set if the ray intersects triangle `i` at a distance in `(0, tmax]`.
+ */
+template <std::size_t N>
+std::uint32_t intersects(const Ray& ray, const TrianglePacket<N>& triangles, float tmax, float* t);
+
+/**
+ * Checks for intersection between a ray and a packet of boxes.
+ *
+ * @param ray Ray with which to check for intersection.
+ * @param aabbs Packet of boxes.
+ * @param tmax Maximum distance along the ray.
+ * @param[out] t Array of `N` distances from the ray origin to the points at which the ray enters each box, clamped to `0` if the origin lies inside a box.
+ * @return Bit mask in which bit `i` is set if the ray intersects box `i` within `[0, tmax]`.
+ */
+template <std::size_t N>
+std::uint32_t intersects(const Ray& ray, const AABBPacket<N>& aabbs, float tmax, float* t);
+
+/**
+ * Checks for intersection between a packet of rays and a triangle.
+ *
+ * @param rays Packet of rays with which to check for intersection.
+ * @param a First vertex in the triangle.
+ * @param b Second vertex in the triangle.
+ * @param c Third vertex in the triangle.
+ * @param[out] t Array of `N` distances from each ray origin to the point of intersection.
+ * @return Bit mask in which bit `i` is set if ray `i` intersects the triangle within its maximum distance.
+ */
+template <std::size_t N>
+std::uint32_t intersects(const RayPacket<N>& rays, const Vector3& a, const Vector3& b, const Vector3& c, float* t);
+
+/**
+ * Checks for intersection between a packet of rays and a box.
+ *
+ * @param rays Packet of rays with which to check for intersection.
+ * @param aabb Box with which to check for intersection.
+ * @param[out] t Array of `N` distances from each ray origin to the point at which it enters the box, clamped to `0` if the origin lies inside the box.
+ * @return Bit mask in which bit `i` is set if ray `i` intersects the box within its maximum distance.
+ */
+template <std::size_t N>
+std::uint32_t intersects(const RayPacket<N>& rays, const AABB& aabb, float* t);
+
+template <std::size_t N>
+inline void RayPacket<N>::set(std::size_t lane, const Ray& ray, float tmax)
+{
+	originX[lane] = ray.origin.x;
+	originY[lane] = ray.origin.y;
+	originZ[lane] = ray.origin.z;
+	directionX[lane] = ray.direction.x;
+	directionY[lane] = ray.direction.y;
+	directionZ[lane] = ray.direction.z;
+	// Slab tests rely on infinite reciprocals being positive
+	Vector3 inverseDirection = 1.0f / ray.direction;
+	inverseDirectionX[lane] = (std::isinf(inverseDirection.x)) ? std::numeric_limits<float>::infinity() : inverseDirection.x;
+	inverseDirectionY[lane] = (std::isinf(inverseDirection.y)) ? std::numeric_limits<float>::infinity() : inverseDirection.y;
+	inverseDirectionZ[lane] = (std::isinf(inverseDirection.z)) ? std::numeric_limits<float>::infinity() : inverseDirection.z;
+	this->tmax[lane] = tmax;
+}
+
+template <std::size_t N>
+inline void RayPacket<N>::clear(std::size_t lane)
+{
+	originX[lane] = originY[lane] = originZ[lane] = 0.0f;
+	directionX[lane] = directionY[lane] = directionZ[lane] = 0.0f;
+	inverseDirectionX[lane] = inverseDirectionY[lane] = inverseDirectionZ[lane] = 0.0f;
+	tmax[lane] = -std::numeric_limits<float>::infinity();
+}
+
+template <std::size_t N>
+inline void TrianglePacket<N>::set(std::size_t lane, const Vector3& a, const Vector3& b, const Vector3& c)
+{
+	ax[lane] = a.x;
+	ay[lane] = a.y;
+	az[lane] = a.z;
+	edge10x[lane] = b.x - a.x;
+	edge10y[lane] = b.y - a.y;
+	edge10z[lane] = b.z - a.z;
+	edge20x[lane] = c.x - a.x;
+	edge20y[lane] = c.y - a.y;
+	edge20z[lane] = c.z - a.z;
+}
+
+template <std::size_t N>
+inline void TrianglePacket<N>::clear(std::size_t lane)
+{
+	ax[lane] = ay[lane] = az[lane] = 0.0f;
+	edge10x[lane] = edge10y[lane] = edge10z[lane] = 0.0f;
+	edge20x[lane] = edge20y[lane] = edge20z[lane] = 0.0f;
+}
+
+template <std::size_t N>
+inline void AABBPacket<N>::set(std::size_t lane, const AABB& aabb)
+{
+	const Vector3& min = aabb.getMin();
+	const Vector3& max = aabb.getMax();
+	minX[lane] = min.x;
+	minY[lane] = min.y;
+	minZ[lane] = min.z;
+	maxX[lane] = max.x;
+	maxY[lane] = max.y;
+	maxZ[lane] = max.z;
+}
+
+template <std::size_t N>
+inline void AABBPacket<N>::clear(std::size_t lane)
+{
+	minX[lane] = minY[lane] = minZ[lane] = std::numeric_limits<float>::infinity();
+	maxX[lane] = maxY[lane] = maxZ[lane] = -std::numeric_limits<float>::infinity();
+}
+
+} // namespace Emergent
+
+#endif // EMERGENT_GEOMETRY_RAY_PACKET_HPP
+
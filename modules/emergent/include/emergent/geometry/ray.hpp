@@ -29,6 +29,7 @@ namespace Emergent
 class Plane;
 class Sphere;
 class AABB;
+class OBB;
 class ConvexHull;
 class BoundingVolume;
 class TriangleMesh;
@@ -73,6 +74,14 @@ public:
 	 */
 	std::tuple<bool, float, float> intersects(const AABB& aabb) const;
 	
+	/**
+	 * Checks for intersection between this ray and an OBB.
+	 *
+	 * @param obb OBB with which to check for intersection.
+	 * @return The first element in the tuple indicates whether or not an intersection occurred, the second and third elements indicate the distance from the origin to the nearest and farthest points of intersection, respectively.
+	 */
+	std::tuple<bool, float, float> intersects(const OBB& obb) const;
+	
 	/**
 	 * Checks for intersection between this ray and a convex hull.
 	 *
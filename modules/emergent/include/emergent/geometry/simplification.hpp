@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2017-2019  Christopher J. Howard
+ *
+ * This file is part of Emergent.
+ *
+ * Emergent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Emergent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Emergent.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef EMERGENT_GEOMETRY_SIMPLIFICATION_HPP
+#define EMERGENT_GEOMETRY_SIMPLIFICATION_HPP
+
+#include <cstdlib>
+#include <vector>
+
+namespace Emergent
+{
+
+class TriangleMesh;
+
+/**
+ * Simplifies a triangle mesh into a chain of progressively coarser levels of detail, using quadric error metric edge collapses. Each edge of the mesh is collapsed into whichever of its two vertices minimizes the summed plane quadrics of both vertices, so every level refers to the vertices of the original mesh. Boundary edges are weighted with perpendicular planes to preserve open borders, and collapses which would flip a triangle or make the mesh non-manifold are rejected.
+ *
+ * @param mesh Triangle mesh to simplify.
+ * @param levelCount Maximum number of levels to generate. Fewer levels are generated if the mesh cannot be simplified further.
+ * @param reduction Ratio between the triangle counts of successive levels, in the range `(0, 1)`.
+ * @param[out] levels Vertex indices of the triangles in each level, from most to least detailed, not including the original mesh.
+ *
+ * @ingroup geometry
+ */
+void simplify(const TriangleMesh& mesh, std::size_t levelCount, float reduction, std::vector<std::vector<std::size_t>>* levels);
+
+} // namespace Emergent
+
+#endif // EMERGENT_GEOMETRY_SIMPLIFICATION_HPP
+
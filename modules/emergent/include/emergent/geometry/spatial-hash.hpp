@@ -0,0 +1,610 @@
+/*
+ * Copyright (C) 2017-2019  Christopher J. Howard
+ *
+ * This file is part of Emergent.
+ *
+ * Emergent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Emergent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Emergent.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef EMERGENT_GEOMETRY_SPATIAL_HASH_HPP
+#define EMERGENT_GEOMETRY_SPATIAL_HASH_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <emergent/math/types.hpp>
+#include <emergent/geometry/aabb.hpp>
+#include <emergent/geometry/bounding-volume.hpp>
+#include <emergent/geometry/obb.hpp>
+#include <emergent/geometry/ray.hpp>
+#include <emergent/geometry/sphere.hpp>
+
+namespace Emergent
+{
+
+/**
+ * A uniform grid of cells, indexed by a hash table of integer cell coordinates.
+ *
+ * Intended for workloads in which every entry moves every step, such as particles, where the index is cheaper to rebuild from scratch than to update. Each entry is stored once, in the cell which contains the center of its bounding volume, and queries are widened by the largest half-extent of any entry volume. Entries therefore should not be much larger than a cell.
+ *
+ * The hash table uses open addressing with linear probing, and entries are sorted by cell with a counting sort so that the entries of each cell are contiguous. Inserted entries become visible to queries once the index is built.
+ *
+ * @tparam T Specifies the entry type.
+ *
+ * @ingroup geometry
+ */
+template <typename T>
+class SpatialHash
+{
+public:
+	/// Specifies the entry type.
+	typedef T EntryType;
+
+	/**
+	 * Creates an instance of SpatialHash.
+	 *
+	 * @param cellSize Specifies the edge length of a cell.
+	 */
+	explicit SpatialHash(float cellSize);
+
+	/**
+	 * Sets the edge length of a cell, which takes effect the next time the index is built.
+	 *
+	 * @param cellSize Specifies the edge length of a cell.
+	 */
+	void setCellSize(float cellSize);
+
+	/**
+	 * Inserts an entry.
+	 *
+	 * @param volume Specifies the bounding volume of the entry.
+	 * @param entry Specifies the entry data.
+	 */
+	void insert(const AABB& volume, const EntryType& entry);
+
+	/**
+	 * Inserts multiple entries.
+	 *
+	 * @param count Specifies the number of entries.
+	 * @param volumes Specifies an array of `count` entry bounding volumes.
+	 * @param entries Specifies an array of `count` entries.
+	 */
+	void insert(std::size_t count, const AABB* volumes, const EntryType* entries);
+
+	/**
+	 * Sorts all inserted entries into cells and rebuilds the hash table, in time linear in the number of entries.
+	 */
+	void build();
+
+	/**
+	 * Removes all entries.
+	 */
+	void clear();
+
+	/**
+	 * Queries the spatial hash for entries intersected by the specified volume. Spheres, AABBs, and OBBs only visit the cells which they overlap, while other volumes are tested against every occupied cell.
+	 *
+	 * @param volume Specifies the volume to query.
+	 * @param[out] results Returns a vector of entries intersected by the specified volume.
+	 */
+	void query(const BoundingVolume& volume, std::vector<EntryType>* results) const;
+
+	/**
+	 * Queries the spatial hash for entries whose bounding volumes are intersected by the specified ray.
+	 *
+	 * @param ray Specifies the ray to query.
+	 * @param[out] results Returns a vector of entries intersected by the specified ray.
+	 */
+	void query(const Ray& ray, std::vector<EntryType>* results) const;
+
+	/**
+	 * Calls a function object for each entry within the specified volume.
+	 *
+	 * @param volume Specifies the volume to query.
+	 * @param visitor Function object with the signature `void(const EntryType&)`.
+	 */
+	template <typename F>
+	void visit(const BoundingVolume& volume, F visitor) const;
+
+	/**
+	 * Calls a function object for each entry whose bounding volume is intersected by the specified ray. Cells are found by stepping along the ray through the grid, and entries are visited in arbitrary order.
+	 *
+	 * @param ray Specifies the ray to query.
+	 * @param visitor Function object with the signature `void(const EntryType&)`.
+	 */
+	template <typename F>
+	void visit(const Ray& ray, F visitor) const;
+
+	/**
+	 * Returns the edge length of a cell.
+	 */
+	float getCellSize() const;
+
+	/**
+	 * Returns the number of occupied cells as of the last build.
+	 */
+	std::size_t getCellCount() const;
+
+	/**
+	 * Returns the number of entries, including those inserted since the last build.
+	 */
+	std::size_t getEntryCount() const;
+
+private:
+	/**
+	 * Entry along with its bounding volume.
+	 */
+	struct Item
+	{
+		AABB volume;
+		EntryType entry;
+	};
+
+	/**
+	 * Occupied cell, which refers to a contiguous range of items.
+	 */
+	struct Cell
+	{
+		std::int32_t coordinates[3];
+		std::uint32_t begin;
+		std::uint32_t count;
+	};
+
+	/// Value of an unoccupied slot in the hash table.
+	static constexpr std::uint32_t emptySlot = std::numeric_limits<std::uint32_t>::max();
+
+	/// Hashes the coordinates of a cell.
+	static std::uint32_t hash(std::int32_t x, std::int32_t y, std::int32_t z);
+
+	/**
+	 * Finds an occupied cell.
+	 *
+	 * @return Index of the cell, or `emptySlot` if the cell is unoccupied.
+	 */
+	std::uint32_t findCell(std::int32_t x, std::int32_t y, std::int32_t z) const;
+
+	/// Returns the bounds of a cell, widened by the largest half-extent of any entry volume.
+	AABB getLooseBounds(const Cell& cell) const;
+
+	/// Calculates the coordinate of the cell which contains a coordinate along an axis, clamped to the range of occupied cells.
+	std::int32_t getCoordinate(float value, std::size_t axis) const;
+
+	float cellSize;
+	float inverseCellSize;
+	float builtCellSize;
+	std::vector<Item> items;
+	std::vector<Item> unsortedItems;
+	std::vector<std::uint32_t> itemCells;
+	std::vector<Cell> cells;
+	std::vector<std::uint32_t> slots;
+	Vector3 maxExtent;
+	AABB bounds;
+	std::int32_t minCoordinates[3];
+	std::int32_t maxCoordinates[3];
+};
+
+template <typename T>
+SpatialHash<T>::SpatialHash(float cellSize):
+	cellSize(cellSize),
+	inverseCellSize(1.0f / cellSize),
+	builtCellSize(cellSize),
+	maxExtent(0.0f)
+{}
+
+template <typename T>
+void SpatialHash<T>::setCellSize(float cellSize)
+{
+	this->cellSize = cellSize;
+}
+
+template <typename T>
+void SpatialHash<T>::insert(const AABB& volume, const EntryType& entry)
+{
+	items.push_back({volume, entry});
+}
+
+template <typename T>
+void SpatialHash<T>::insert(std::size_t count, const AABB* volumes, const EntryType* entries)
+{
+	items.reserve(items.size() + count);
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		items.push_back({volumes[i], entries[i]});
+	}
+}
+
+template <typename T>
+void SpatialHash<T>::build()
+{
+	builtCellSize = cellSize;
+	inverseCellSize = 1.0f / cellSize;
+	cells.clear();
+
+	if (items.empty())
+	{
+		return;
+	}
+
+	// Size the hash table for a load factor of at most one half, as each entry may occupy a separate cell
+	std::size_t slotCount = 16;
+	while (slotCount < items.size() * 2)
+	{
+		slotCount <<= 1;
+	}
+	slots.assign(slotCount, emptySlot);
+	std::uint32_t slotMask = static_cast<std::uint32_t>(slotCount - 1);
+
+	// Find the cell of each item, counting the items in each cell
+	Vector3 minPoint(std::numeric_limits<float>::infinity());
+	Vector3 maxPoint(-std::numeric_limits<float>::infinity());
+	maxExtent = Vector3(0.0f);
+	for (std::size_t axis = 0; axis < 3; ++axis)
+	{
+		minCoordinates[axis] = std::numeric_limits<std::int32_t>::max();
+		maxCoordinates[axis] = std::numeric_limits<std::int32_t>::min();
+	}
+
+	itemCells.resize(items.size());
+	for (std::size_t i = 0; i < items.size(); ++i)
+	{
+		const AABB& volume = items[i].volume;
+		Vector3 center = (volume.getMin() + volume.getMax()) * 0.5f;
+		maxExtent = glm::max(maxExtent, volume.getMax() - center);
+		minPoint = glm::min(minPoint, volume.getMin());
+		maxPoint = glm::max(maxPoint, volume.getMax());
+
+		std::int32_t coordinates[3];
+		for (std::size_t axis = 0; axis < 3; ++axis)
+		{
+			coordinates[axis] = static_cast<std::int32_t>(std::floor(center[axis] * inverseCellSize));
+			minCoordinates[axis] = std::min(minCoordinates[axis], coordinates[axis]);
+			maxCoordinates[axis] = std::max(maxCoordinates[axis], coordinates[axis]);
+		}
+
+		std::uint32_t slot = hash(coordinates[0], coordinates[1], coordinates[2]) & slotMask;
+		for (;;)
+		{
+			std::uint32_t index = slots[slot];
+			if (index == emptySlot)
+			{
+				index = static_cast<std::uint32_t>(cells.size());
+				slots[slot] = index;
+				cells.push_back({{coordinates[0], coordinates[1], coordinates[2]}, 0, 0});
+			}
+
+			Cell& cell = cells[index];
+			if (cell.coordinates[0] == coordinates[0] && cell.coordinates[1] == coordinates[1] && cell.coordinates[2] == coordinates[2])
+			{
+				++cell.count;
+				itemCells[i] = index;
+				break;
+			}
+
+			slot = (slot + 1) & slotMask;
+		}
+	}
+	bounds = AABB(minPoint, maxPoint);
+
+	// Assign a contiguous range of items to each cell
+	std::uint32_t begin = 0;
+	for (Cell& cell: cells)
+	{
+		cell.begin = begin;
+		begin += cell.count;
+		cell.count = 0;
+	}
+
+	// Scatter items into their cells
+	unsortedItems.swap(items);
+	items.resize(unsortedItems.size());
+	for (std::size_t i = 0; i < unsortedItems.size(); ++i)
+	{
+		Cell& cell = cells[itemCells[i]];
+		items[cell.begin + cell.count++] = std::move(unsortedItems[i]);
+	}
+	unsortedItems.clear();
+}
+
+template <typename T>
+void SpatialHash<T>::clear()
+{
+	items.clear();
+	cells.clear();
+}
+
+template <typename T>
+void SpatialHash<T>::query(const BoundingVolume& volume, std::vector<EntryType>* results) const
+{
+	visit(volume, [results](const EntryType& entry) { results->push_back(entry); });
+}
+
+template <typename T>
+void SpatialHash<T>::query(const Ray& ray, std::vector<EntryType>* results) const
+{
+	visit(ray, [results](const EntryType& entry) { results->push_back(entry); });
+}
+
+template <typename T>
+template <typename F>
+void SpatialHash<T>::visit(const BoundingVolume& volume, F visitor) const
+{
+	if (cells.empty())
+	{
+		return;
+	}
+
+	auto visitCell = [this, &volume, &visitor](const Cell& cell)
+	{
+		for (std::uint32_t i = cell.begin; i < cell.begin + cell.count; ++i)
+		{
+			if (volume.intersects(items[i].volume))
+			{
+				visitor(items[i].entry);
+			}
+		}
+	};
+
+	// Find the range of cells which may contain the centers of intersected entries
+	AABB region;
+	if (volume.getType() == BoundingVolume::Type::SPHERE)
+	{
+		const Sphere& sphere = static_cast<const Sphere&>(volume);
+		Vector3 radius(sphere.getRadius());
+		region = AABB(sphere.getCenter() - radius, sphere.getCenter() + radius);
+	}
+	else if (volume.getType() == BoundingVolume::Type::AABB)
+	{
+		region = static_cast<const AABB&>(volume);
+	}
+	else if (volume.getType() == BoundingVolume::Type::OBB)
+	{
+		region = static_cast<const OBB&>(volume).getBounds();
+	}
+
+	if (volume.getType() != BoundingVolume::Type::CONVEX_HULL)
+	{
+		if (!region.intersects(bounds))
+		{
+			return;
+		}
+
+		std::int32_t first[3];
+		std::int32_t last[3];
+		std::size_t regionCellCount = 1;
+		for (std::size_t axis = 0; axis < 3; ++axis)
+		{
+			first[axis] = getCoordinate(region.getMin()[axis] - maxExtent[axis], axis);
+			last[axis] = getCoordinate(region.getMax()[axis] + maxExtent[axis], axis);
+			regionCellCount *= static_cast<std::size_t>(last[axis] - first[axis] + 1);
+		}
+
+		// Look up each cell in the region, unless the region spans more cells than are occupied
+		if (regionCellCount <= cells.size())
+		{
+			for (std::int32_t z = first[2]; z <= last[2]; ++z)
+			{
+				for (std::int32_t y = first[1]; y <= last[1]; ++y)
+				{
+					for (std::int32_t x = first[0]; x <= last[0]; ++x)
+					{
+						std::uint32_t index = findCell(x, y, z);
+						if (index != emptySlot)
+						{
+							visitCell(cells[index]);
+						}
+					}
+				}
+			}
+
+			return;
+		}
+	}
+
+	for (const Cell& cell: cells)
+	{
+		if (volume.intersects(getLooseBounds(cell)))
+		{
+			visitCell(cell);
+		}
+	}
+}
+
+template <typename T>
+template <typename F>
+void SpatialHash<T>::visit(const Ray& ray, F visitor) const
+{
+	if (cells.empty())
+	{
+		return;
+	}
+
+	// Clip the ray to the bounds of all entries
+	auto intersection = ray.intersects(bounds);
+	if (!std::get<0>(intersection))
+	{
+		return;
+	}
+	float t = std::max(0.0f, std::get<1>(intersection));
+	float tEnd = std::get<2>(intersection);
+
+	// Entries may overlap cells up to this many cells away from the cell which contains their center
+	std::int32_t reach[3];
+	for (std::size_t axis = 0; axis < 3; ++axis)
+	{
+		reach[axis] = static_cast<std::int32_t>(std::ceil(maxExtent[axis] * inverseCellSize));
+	}
+
+	// Set up a 3D DDA traversal of the cells along the ray
+	Vector3 start = ray.origin + ray.direction * t;
+	std::int32_t coordinates[3];
+	std::int32_t step[3];
+	float tNext[3];
+	float tDelta[3];
+	for (std::size_t axis = 0; axis < 3; ++axis)
+	{
+		coordinates[axis] = getCoordinate(start[axis], axis);
+		if (ray.direction[axis] > 0.0f)
+		{
+			step[axis] = 1;
+			tNext[axis] = t + (static_cast<float>(coordinates[axis] + 1) * builtCellSize - start[axis]) / ray.direction[axis];
+			tDelta[axis] = builtCellSize / ray.direction[axis];
+		}
+		else if (ray.direction[axis] < 0.0f)
+		{
+			step[axis] = -1;
+			tNext[axis] = t + (static_cast<float>(coordinates[axis]) * builtCellSize - start[axis]) / ray.direction[axis];
+			tDelta[axis] = -builtCellSize / ray.direction[axis];
+		}
+		else
+		{
+			step[axis] = 0;
+			tNext[axis] = std::numeric_limits<float>::infinity();
+			tDelta[axis] = std::numeric_limits<float>::infinity();
+		}
+	}
+
+	// Gather the occupied cells around each cell along the ray
+	std::vector<std::uint32_t> candidates;
+	for (;;)
+	{
+		for (std::int32_t z = coordinates[2] - reach[2]; z <= coordinates[2] + reach[2]; ++z)
+		{
+			for (std::int32_t y = coordinates[1] - reach[1]; y <= coordinates[1] + reach[1]; ++y)
+			{
+				for (std::int32_t x = coordinates[0] - reach[0]; x <= coordinates[0] + reach[0]; ++x)
+				{
+					std::uint32_t index = findCell(x, y, z);
+					if (index != emptySlot)
+					{
+						candidates.push_back(index);
+					}
+				}
+			}
+		}
+
+		std::size_t axis = (tNext[0] < tNext[1]) ? ((tNext[0] < tNext[2]) ? 0 : 2) : ((tNext[1] < tNext[2]) ? 1 : 2);
+		if (tNext[axis] > tEnd)
+		{
+			break;
+		}
+
+		coordinates[axis] += step[axis];
+		tNext[axis] += tDelta[axis];
+		if (coordinates[axis] < minCoordinates[axis] - reach[axis] || coordinates[axis] > maxCoordinates[axis] + reach[axis])
+		{
+			break;
+		}
+	}
+
+	// Neighbouring cells along the ray share candidates
+	if (reach[0] || reach[1] || reach[2])
+	{
+		std::sort(candidates.begin(), candidates.end());
+		candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+	}
+
+	for (std::uint32_t index: candidates)
+	{
+		const Cell& cell = cells[index];
+		if (!std::get<0>(ray.intersects(getLooseBounds(cell))))
+		{
+			continue;
+		}
+
+		for (std::uint32_t i = cell.begin; i < cell.begin + cell.count; ++i)
+		{
+			if (std::get<0>(ray.intersects(items[i].volume)))
+			{
+				visitor(items[i].entry);
+			}
+		}
+	}
+}
+
+template <typename T>
+inline float SpatialHash<T>::getCellSize() const
+{
+	return cellSize;
+}
+
+template <typename T>
+inline std::size_t SpatialHash<T>::getCellCount() const
+{
+	return cells.size();
+}
+
+template <typename T>
+inline std::size_t SpatialHash<T>::getEntryCount() const
+{
+	return items.size();
+}
+
+template <typename T>
+inline std::uint32_t SpatialHash<T>::hash(std::int32_t x, std::int32_t y, std::int32_t z)
+{
+	std::uint32_t h = static_cast<std::uint32_t>(x) * 73856093u ^ static_cast<std::uint32_t>(y) * 19349663u ^ static_cast<std::uint32_t>(z) * 83492791u;
+	return (h ^ (h >> 16)) * 0x9E3779B1u;
+}
+
+template <typename T>
+std::uint32_t SpatialHash<T>::findCell(std::int32_t x, std::int32_t y, std::int32_t z) const
+{
+	std::uint32_t slotMask = static_cast<std::uint32_t>(slots.size() - 1);
+	std::uint32_t slot = hash(x, y, z) & slotMask;
+	for (;;)
+	{
+		std::uint32_t index = slots[slot];
+		if (index == emptySlot)
+		{
+			return emptySlot;
+		}
+
+		const Cell& cell = cells[index];
+		if (cell.coordinates[0] == x && cell.coordinates[1] == y && cell.coordinates[2] == z)
+		{
+			return index;
+		}
+
+		slot = (slot + 1) & slotMask;
+	}
+}
+
+template <typename T>
+AABB SpatialHash<T>::getLooseBounds(const Cell& cell) const
+{
+	Vector3 minPoint(cell.coordinates[0], cell.coordinates[1], cell.coordinates[2]);
+	minPoint *= builtCellSize;
+	return AABB(minPoint - maxExtent, minPoint + Vector3(builtCellSize) + maxExtent);
+}
+
+template <typename T>
+inline std::int32_t SpatialHash<T>::getCoordinate(float value, std::size_t axis) const
+{
+	float coordinate = std::floor(value * inverseCellSize);
+	coordinate = std::max(coordinate, static_cast<float>(minCoordinates[axis]));
+	coordinate = std::min(coordinate, static_cast<float>(maxCoordinates[axis]));
+	return static_cast<std::int32_t>(coordinate);
+}
+
+} // namespace Emergent
+
+#endif // EMERGENT_GEOMETRY_SPATIAL_HASH_HPP
+
@@ -27,6 +27,7 @@ namespace Emergent
 {
 
 class AABB;
+class OBB;
 
 /**
  * Bounding sphere.
@@ -45,9 +46,15 @@ public:
 	const Vector3& getCenter() const;
 	float getRadius() const;
 	
+	/**
+	 * Transforms this sphere. The radius is scaled by the largest scale factor, so the result contains the transformed sphere under non-uniform scales.
+	 */
+	Sphere transformed(const Transform& transform) const;
+	
 	virtual BoundingVolume::Type getType() const;
 	virtual bool intersects(const Sphere& sphere) const;
 	virtual bool intersects(const AABB& aabb) const;
+	virtual bool intersects(const OBB& obb) const;
 	virtual bool contains(const Vector3& point) const;
 	virtual bool contains(const Sphere& sphere) const;
 	virtual bool contains(const AABB& aabb) const;
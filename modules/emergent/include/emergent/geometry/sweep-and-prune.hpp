@@ -0,0 +1,167 @@
+/*
+ * Copyright (C) 2017-2019  Christopher J. Howard
+ *
+ * This file is part of Emergent.
+ *
+ * Emergent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Emergent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Emergent.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef EMERGENT_GEOMETRY_SWEEP_AND_PRUNE_HPP
+#define EMERGENT_GEOMETRY_SWEEP_AND_PRUNE_HPP
+
+#include <emergent/geometry/aabb.hpp>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace Emergent
+{
+
+/**
+ * Incremental sweep-and-prune broadphase, which finds the pairs of overlapping boxes among a set of moving boxes.
+ *
+ * The minimum and maximum endpoints of every box are kept sorted along each axis. As boxes usually move only a little between steps, the arrays are nearly sorted and are re-sorted with insertion sort in close to linear time. Whenever a minimum and a maximum endpoint swap places, the overlap of their boxes may have changed, so only those boxes are tested against each other. Boxes which touch are considered to overlap.
+ *
+ * @ingroup geometry
+ */
+class SweepAndPrune
+{
+public:
+	/// Specifies the type of handle which refers to an inserted box.
+	typedef std::uint32_t HandleType;
+
+	/// Specifies the type of an overlapping pair of boxes, with the lower handle first.
+	typedef std::tuple<HandleType, HandleType> PairType;
+
+	/**
+	 * Creates an instance of SweepAndPrune.
+	 */
+	SweepAndPrune();
+
+	/**
+	 * Inserts a box. Its overlaps are reported by the next step.
+	 *
+	 * @param bounds Specifies the bounds of the box.
+	 * @return Handle to the inserted box.
+	 */
+	HandleType insert(const AABB& bounds);
+
+	/**
+	 * Removes a box. Its overlaps are reported as removed pairs by the next step, after which the handle may be reused by a subsequent insertion.
+	 *
+	 * @param handle Specifies the handle of a previously inserted box.
+	 */
+	void remove(HandleType handle);
+
+	/**
+	 * Updates the bounds of a box. Its overlaps are updated by the next step.
+	 *
+	 * @param handle Specifies the handle of a previously inserted box.
+	 * @param bounds Specifies the new bounds of the box.
+	 */
+	void update(HandleType handle, const AABB& bounds);
+
+	/**
+	 * Re-sorts the endpoints of all boxes and updates the set of overlapping pairs. Pairs which begin and stop overlapping within a single step are not reported.
+	 *
+	 * @param[out] added Returns the pairs which began overlapping since the previous step. Pairs are appended to the vector. May be `nullptr`.
+	 * @param[out] removed Returns the pairs which stopped overlapping since the previous step, including the pairs of removed boxes. Pairs are appended to the vector. May be `nullptr`.
+	 */
+	void step(std::vector<PairType>* added, std::vector<PairType>* removed);
+
+	/**
+	 * Removes all boxes and pairs, without reporting them.
+	 */
+	void clear();
+
+	/**
+	 * Returns all overlapping pairs as of the previous step.
+	 *
+	 * @param[out] pairs Returns the overlapping pairs. Pairs are appended to the vector.
+	 */
+	void getPairs(std::vector<PairType>* pairs) const;
+
+	/// Returns the number of overlapping pairs as of the previous step.
+	std::size_t getPairCount() const;
+
+	/// Returns the number of boxes.
+	std::size_t getBoxCount() const;
+
+private:
+	/**
+	 * Endpoint of a box along one axis.
+	 */
+	struct Endpoint
+	{
+		/// Coordinate of the endpoint along the axis
+		float value;
+
+		/// Handle of the box, shifted left by one, with the lowest bit set if this is a maximum endpoint. Also the index of the endpoint value in the extents of its axis.
+		std::uint32_t data;
+	};
+
+	/// Returns the key of the pair formed by two boxes.
+	static std::uint64_t getPairKey(HandleType a, HandleType b);
+
+	/// Returns `true` if the two boxes overlap along all axes.
+	bool overlaps(HandleType a, HandleType b) const;
+
+	/// Adds a pair, recording its previous state if it was not yet changed during this step.
+	void addPair(HandleType a, HandleType b);
+
+	/// Removes a pair, recording its previous state if it was not yet changed during this step.
+	void removePair(HandleType a, HandleType b);
+
+	/// Sorts the endpoints along one axis with insertion sort, updating pairs as minimum and maximum endpoints swap places.
+	void sortAxis(std::size_t axis);
+
+	/// Sorts the endpoints along all axes from scratch and finds all pairs with a single sweep, which is faster than insertion sort after many insertions.
+	void rebuild();
+
+	std::vector<float> extents[3];
+	std::vector<bool> active;
+	std::vector<std::uint32_t> pairCounts;
+	std::vector<Endpoint> endpoints[3];
+	std::unordered_set<std::uint64_t> pairs;
+	std::unordered_map<std::uint64_t, bool> changes;
+	std::vector<HandleType> freeHandles;
+	std::vector<HandleType> removedHandles;
+	std::size_t boxCount;
+	std::size_t insertionCount;
+};
+
+inline std::size_t SweepAndPrune::getPairCount() const
+{
+	return pairs.size();
+}
+
+inline std::size_t SweepAndPrune::getBoxCount() const
+{
+	return boxCount;
+}
+
+inline std::uint64_t SweepAndPrune::getPairKey(HandleType a, HandleType b)
+{
+	return (a < b) ? (static_cast<std::uint64_t>(a) << 32) | b : (static_cast<std::uint64_t>(b) << 32) | a;
+}
+
+} // namespace Emergent
+
+#endif // EMERGENT_GEOMETRY_SWEEP_AND_PRUNE_HPP
+
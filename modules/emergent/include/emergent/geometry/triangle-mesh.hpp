@@ -21,7 +21,9 @@
 #define EMERGENT_GEOMETRY_TRIANGLE_MESH_HPP
 
 #include <emergent/math/types.hpp>
+#include <cstdint>
 #include <iostream>
+#include <limits>
 #include <string>
 #include <vector>
 
@@ -29,7 +31,7 @@ namespace Emergent
 {
 
 /**
- * Winged-edge triangle mesh.
+ * Half-edge triangle mesh. Vertices, half-edges, and triangles are stored in contiguous arrays and refer to each other with 32-bit indices. The three half-edges of triangle `i` are stored at indices `3i`, `3i + 1`, and `3i + 2`, so the parent triangle, next, and previous half-edges of any half-edge are implied by its index.
  *
  * @ingroup geometry
  */
@@ -40,133 +42,155 @@ public:
 	struct Edge;
 	struct Triangle;
 
+	/// Index which refers to no element, such as the symmetric edge of a boundary edge
+	static constexpr std::uint32_t invalidIndex = std::numeric_limits<std::uint32_t>::max();
+
 	/**
 	 * Creates a triangle mesh from a list of vertices and indices.
 	 *
 	 * @param vertices Specifies a list of vertices.
 	 * @param indices Specifies a list of indices.
-	 * @return `true` if the mesh was successfully created, `false` otherwise.
+	 * @throw std::runtime_error Index count is not a multiple of 3, or the mesh contains an invalid index.
 	 */
 	TriangleMesh(const std::vector<Vector3>& vertices, const std::vector<std::size_t>& indices);
 	
-	/**
-	 * Destroys a triangle mesh.
-	 */
-	~TriangleMesh();
-		
 	/// Returns a pointer to the triangle mesh vertices
-	const std::vector<TriangleMesh::Vertex*>* getVertices() const;
+	const std::vector<TriangleMesh::Vertex>* getVertices() const;
 	
-	/// Returns a pointer to the triangle mesh edges
-	const std::vector<TriangleMesh::Edge*>* getEdges() const;
+	/// Returns a pointer to the triangle mesh half-edges
+	const std::vector<TriangleMesh::Edge>* getEdges() const;
 	
 	/// Returns a pointer to the triangle mesh triangles
-	const std::vector<TriangleMesh::Triangle*>* getTriangles() const;
+	const std::vector<TriangleMesh::Triangle>* getTriangles() const;
 	
 	/// @copydoc TriangleMesh::getVertices() const
-	std::vector<TriangleMesh::Vertex*>* getVertices();
+	std::vector<TriangleMesh::Vertex>* getVertices();
 	
 	/// @copydoc TriangleMesh::getEdges() const
-	std::vector<TriangleMesh::Edge*>* getEdges();
+	std::vector<TriangleMesh::Edge>* getEdges();
 	
 	/// @copydoc TriangleMesh::getTriangles() const
-	std::vector<TriangleMesh::Triangle*>* getTriangles();
+	std::vector<TriangleMesh::Triangle>* getTriangles();
+	
+	/// Returns the index of the first half-edge of a triangle.
+	static std::uint32_t getEdge(std::uint32_t triangle);
+	
+	/// Returns the index of the triangle to which a half-edge belongs.
+	static std::uint32_t getTriangle(std::uint32_t edge);
+	
+	/// Returns the index of the next half-edge in the parent triangle of a half-edge.
+	static std::uint32_t getNext(std::uint32_t edge);
+	
+	/// Returns the index of the previous half-edge in the parent triangle of a half-edge.
+	static std::uint32_t getPrevious(std::uint32_t edge);
+	
+	/// Returns the position of the vertex at which a half-edge starts.
+	const Vector3& getPosition(std::uint32_t edge) const;
 	
 	/**
-	 * Winged-edge vertex which contains a pointer to its parent edge, a position vector, and an index.
+	 * Half-edge vertex which contains a position vector and the index of a half-edge which starts at the vertex.
 	 */
 	struct Vertex
 	{
-		/// Pointer to the edge to which this vertex belongs
-		TriangleMesh::Edge* edge;
-		
 		/// Vertex position vector
 		Vector3 position;
 		
-		/// Index of this vertex
-		std::size_t index;
+		/// Index of a half-edge which starts at this vertex
+		std::uint32_t edge;
 	};
 	
 	/**
-	 * Winged-edge edge which contains pointers to its starting vertex, parent triangle, and related edges.
+	 * Half-edge which contains the indices of its starting vertex and its symmetric half-edge.
 	 */
 	struct Edge
 	{
-		/// Pointer to the vertex at which the edge starts
-		TriangleMesh::Vertex* vertex;     
-		
-		/// Pointer to the triangle to which this edge belongs
-		TriangleMesh::Triangle* triangle;
-		
-		/// Pointer to the previous edge in the parent triangle
-		TriangleMesh::Edge* previous;
-		
-		/// Pointer to the next edge in the parent triangle
-		TriangleMesh::Edge* next;
+		/// Index of the vertex at which the half-edge starts
+		std::uint32_t vertex;
 		
-		/// Pointer to the symmetric edge
-		TriangleMesh::Edge* symmetric;
-		
-		/// Index of this edge
-		std::size_t index;
+		/// Index of the symmetric half-edge, or TriangleMesh::invalidIndex if this is a boundary edge
+		std::uint32_t symmetric;
 	};
 	
 	/**
-	 * Winged-edge triangle which contains a pointer to its first edge and its normal vector.
+	 * Triangle which contains its normal vector.
 	 */
 	struct Triangle
 	{
-		/// Pointer to the first edge in this triangle
-		TriangleMesh::Edge* edge;
-		
 		/// Faceted surface normal
 		Vector3 normal;
-		
-		/// Index of this triangle
-		std::size_t index;
 	};
 	
-private:	
+private:
+	/**
+	 * Connects each half-edge to its symmetric half-edge, by bucketing half-edges by their start vertices.
+	 */
+	void connectEdges();
+	
 	/**
 	 * Calculates the faceted surface normals for each triangle.
 	 */
 	void calculateNormals();
 	
-	std::vector<TriangleMesh::Vertex*> vertices;
-	std::vector<TriangleMesh::Edge*> edges;
-	std::vector<TriangleMesh::Triangle*> triangles;
+	std::vector<TriangleMesh::Vertex> vertices;
+	std::vector<TriangleMesh::Edge> edges;
+	std::vector<TriangleMesh::Triangle> triangles;
 };
 
-inline const std::vector<TriangleMesh::Vertex*>* TriangleMesh::getVertices() const
+inline const std::vector<TriangleMesh::Vertex>* TriangleMesh::getVertices() const
 {
 	return &vertices;
 }
 
-inline const std::vector<TriangleMesh::Edge*>* TriangleMesh::getEdges() const
+inline const std::vector<TriangleMesh::Edge>* TriangleMesh::getEdges() const
 {
 	return &edges;
 }
 
-inline const std::vector<TriangleMesh::Triangle*>* TriangleMesh::getTriangles() const
+inline const std::vector<TriangleMesh::Triangle>* TriangleMesh::getTriangles() const
 {
 	return &triangles;
 }
 
-inline std::vector<TriangleMesh::Vertex*>* TriangleMesh::getVertices()
+inline std::vector<TriangleMesh::Vertex>* TriangleMesh::getVertices()
 {
 	return &vertices;
 }
 
-inline std::vector<TriangleMesh::Edge*>* TriangleMesh::getEdges()
+inline std::vector<TriangleMesh::Edge>* TriangleMesh::getEdges()
 {
 	return &edges;
 }
 
-inline std::vector<TriangleMesh::Triangle*>* TriangleMesh::getTriangles()
+inline std::vector<TriangleMesh::Triangle>* TriangleMesh::getTriangles()
 {
 	return &triangles;
 }
 
+inline std::uint32_t TriangleMesh::getEdge(std::uint32_t triangle)
+{
+	return triangle * 3;
+}
+
+inline std::uint32_t TriangleMesh::getTriangle(std::uint32_t edge)
+{
+	return edge / 3;
+}
+
+inline std::uint32_t TriangleMesh::getNext(std::uint32_t edge)
+{
+	return (edge % 3 == 2) ? edge - 2 : edge + 1;
+}
+
+inline std::uint32_t TriangleMesh::getPrevious(std::uint32_t edge)
+{
+	return (edge % 3 == 0) ? edge + 2 : edge - 1;
+}
+
+inline const Vector3& TriangleMesh::getPosition(std::uint32_t edge) const
+{
+	return vertices[edges[edge].vertex].position;
+}
+
 } // namespace Emergent
 
 #endif // EMERGENT_GEOMETRY_TRIANGLE_MESH_HPP
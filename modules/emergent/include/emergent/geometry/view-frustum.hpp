@@ -38,9 +38,14 @@ public:
 	 * Creates an instance of ViewFrustum.
 	 */
 	ViewFrustum();
-
-	ViewFrustum(const ViewFrustum& viewFrustum);
-	ViewFrustum& operator=(const ViewFrustum& viewFrustum);
+	
+	/**
+	 * Creates an instance of ViewFrustum from view and projection matrices.
+	 *
+	 * @param view Camera view matrix.
+	 * @param projection Camera projection matrix.
+	 */
+	ViewFrustum(const Matrix4& view, const Matrix4& projection);
 	
 	/**
 	 * Sets the view matrix of the frustum.
@@ -115,7 +120,7 @@ public:
 	std::size_t getCornerCount() const;
 	
 	/**
-	 * Returns the frustum corner at the specified index. The corners are stored in the following order: `ntl`, `ntr`, `nbl`, `nbr`, `ftl`, `ftr`, `fbl`, `fbr`. The corners are referred to by the three intersecting planes at which they are located. Where `n` is near, `f` is far, `t` is top, `b` is bottom, `l` is left, and `r` is right. So `ntl` refers to the corner at the intersection of the near, top, and left planes.
+	 * Returns the frustum corner at the specified index. Corners are calculated on first access after the frustum changes. The corners are stored in the following order: `ntl`, `ntr`, `nbl`, `nbr`, `ftl`, `ftr`, `fbl`, `fbr`. The corners are referred to by the three intersecting planes at which they are located. Where `n` is near, `f` is far, `t` is top, `b` is bottom, `l` is left, and `r` is right. So `ntl` refers to the corner at the intersection of the near, top, and left planes.
 	 *
 	 * @param index Index of a corner.
 	 */
@@ -129,12 +134,13 @@ protected:
 	
 private:
 	void recalculatePlanes();
-	void recalculateCorners();	
+	void recalculateCorners() const;
 	
 	Matrix4 view;
 	Matrix4 projection;
 	Matrix4 viewProjection;
-	Vector3 corners[8];
+	mutable Vector3 corners[8];
+	mutable bool cornersDirty;
 };
 
 inline const Matrix4& ViewFrustum::getViewMatrix() const
@@ -189,6 +195,11 @@ inline std::size_t ViewFrustum::getCornerCount() const
 
 inline const Vector3& ViewFrustum::getCorner(std::size_t index) const
 {
+	if (cornersDirty)
+	{
+		recalculateCorners();
+	}
+
 	return corners[index];
 }
 
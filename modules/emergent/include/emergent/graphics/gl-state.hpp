@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2017-2019  Christopher J. Howard
+ *
+ * This file is part of Emergent.
+ *
+ * Emergent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Emergent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Emergent.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef EMERGENT_GRAPHICS_GL_STATE_HPP
+#define EMERGENT_GRAPHICS_GL_STATE_HPP
+
+#include <emergent/graphics/gl3w.hpp>
+#include <cstdlib>
+
+namespace Emergent
+{
+
+/**
+ * Tracks the OpenGL state of the current context and filters redundant state changes before they reach the driver.
+ *
+ * Bindings of the program, vertex array, array, element array, and uniform buffers, framebuffers, and the 2D and cube map textures of each texture unit are cached, as are the capabilities set with glEnable() and glDisable(), the blend function, the depth function and mask, and the culled face. State which has not been set through GLState since the last call to invalidate() is unknown, so the first change to it is always issued.
+ *
+ * Objects whose names may be cached must be deleted through GLState, so that a newly generated object which reuses a name is not mistaken for a bound one. Code which changes state by calling OpenGL directly must call invalidate() afterwards.
+ *
+ * @ingroup graphics
+ */
+class GLState
+{
+public:
+	/**
+	 * Counts state changes since the counters were last reset.
+	 */
+	struct Counters
+	{
+		/// Number of state changes which were issued to the driver
+		std::size_t issued;
+
+		/// Number of redundant state changes which were filtered
+		std::size_t skipped;
+	};
+
+	/**
+	 * Forgets all cached state, so that subsequent state changes are issued regardless of their values. This should be called after the context is created, and after OpenGL state is changed without going through GLState.
+	 */
+	static void invalidate();
+
+	/// Makes a program current, as with glUseProgram().
+	static void useProgram(GLuint program);
+
+	/// Binds a vertex array object, as with glBindVertexArray().
+	static void bindVertexArray(GLuint vao);
+
+	/// Binds a buffer, as with glBindBuffer(). Only array, element array, and uniform buffer bindings are cached.
+	static void bindBuffer(GLenum target, GLuint buffer);
+
+	/// Binds a buffer to an indexed binding point, as with glBindBufferBase(). Only the first 16 uniform buffer binding points are cached.
+	static void bindBufferBase(GLenum target, GLuint index, GLuint buffer);
+
+	/**
+	 * Binds a texture to a texture unit, making the unit active as with glActiveTexture() and binding the texture as with glBindTexture(). Only 2D and cube map textures on the first 32 units are cached.
+	 *
+	 * @param unit Index of the texture unit, starting from zero.
+	 * @param target Texture target, such as `GL_TEXTURE_2D`.
+	 * @param texture Name of the texture.
+	 */
+	static void bindTexture(GLuint unit, GLenum target, GLuint texture);
+
+	/// Binds a framebuffer, as with glBindFramebuffer().
+	static void bindFramebuffer(GLenum target, GLuint framebuffer);
+
+	/// Enables or disables a capability, as with glEnable() and glDisable(). Only `GL_BLEND`, `GL_CULL_FACE`, `GL_DEPTH_TEST`, `GL_SCISSOR_TEST`, and `GL_STENCIL_TEST` are cached.
+	static void setEnabled(GLenum capability, bool enabled);
+
+	/// Sets the blend function, as with glBlendFunc().
+	static void setBlendFunc(GLenum source, GLenum destination);
+
+	/// Sets the depth comparison function, as with glDepthFunc().
+	static void setDepthFunc(GLenum function);
+
+	/// Enables or disables writing to the depth buffer, as with glDepthMask().
+	static void setDepthMask(bool enabled);
+
+	/// Sets which faces are culled, as with glCullFace().
+	static void setCullFace(GLenum face);
+
+	/// Deletes a program, as with glDeleteProgram().
+	static void deleteProgram(GLuint program);
+
+	/// Deletes a vertex array object, as with glDeleteVertexArrays().
+	static void deleteVertexArray(GLuint vao);
+
+	/// Deletes a buffer, as with glDeleteBuffers().
+	static void deleteBuffer(GLuint buffer);
+
+	/// Deletes a texture, as with glDeleteTextures().
+	static void deleteTexture(GLuint texture);
+
+	/// Deletes a framebuffer, as with glDeleteFramebuffers().
+	static void deleteFramebuffer(GLuint framebuffer);
+
+	/// Returns the state change counters.
+	static const Counters& getCounters();
+
+	/// Resets the state change counters to zero. This is typically called once per frame.
+	static void resetCounters();
+};
+
+} // namespace Emergent
+
+#endif // EMERGENT_GRAPHICS_GL_STATE_HPP
+
@@ -134,7 +134,7 @@ public:
 	std::uint64_t getFlags() const;
 	
 	/**
-	 * Calls the `ShaderVariableBase::upload() const` function of each shader variable in the material.
+	 * Calls the `ShaderVariableBase::upload() const` function of each shader variable in the material. Variables whose values have not changed since they were last uploaded to the active shader permutation are not retransmitted.
 	 *
 	 * @return `true` if all variables were successfully uploaded, `false` otherwise.
 	 */
@@ -23,6 +23,8 @@
 #include <emergent/graphics/gl3w.hpp>
 #include <emergent/graphics/vertex-format.hpp>
 #include <emergent/geometry/aabb.hpp>
+#include <emergent/geometry/obb.hpp>
+#include <emergent/geometry/sphere.hpp>
 #include <string>
 #include <vector>
 #include <map>
@@ -43,6 +45,21 @@ class TriangleMesh;
 class Model
 {
 public:
+	/**
+	 * A simplified version of the geometry of a model group, which is rendered in place of the full-detail geometry when the model is small on screen.
+	 */
+	struct LevelOfDetail
+	{
+		/// Offset to the index of the first triangle in this level
+		std::uint32_t indexOffset;
+		
+		/// Number of triangles in this level.
+		std::uint32_t triangleCount;
+		
+		/// Projected size, as a fraction of the viewport height, below which this level is used.
+		float screenSize;
+	};
+	
 	/**
 	 * A model group encapsulates the geometry of a model which corresponds to a specific material.
 	 */
@@ -62,6 +79,9 @@ public:
 		
 		/// AABB which contains all geometry in this group.
 		AABB bounds;
+		
+		/// Simplified levels of detail of this group, from most to least detailed.
+		std::vector<Model::LevelOfDetail> levels;
 	};
 	
 	/**
@@ -80,12 +100,14 @@ public:
 	void destroy();
 	
 	/**
-	 * Creates a model from a triangle mesh.
+	 * Creates a model from a triangle mesh. Corners of the mesh which share a vertex and a normal are welded into a single indexed vertex, triangles are reordered for the post-transform vertex cache, and vertices are reordered by first use. The bounds, bounding sphere, and oriented bounds of the model are fitted to the mesh vertices.
 	 *
 	 * @param mesh Specifies the triangle mesh from which to create a model.
+	 * @param smoothNormals Specifies whether vertex normals should be averaged over the triangles which share each vertex, rather than taken from each triangle.
+	 * @param levelCount Specifies the maximum number of simplified levels of detail to generate. Each level has half as many triangles as the previous level.
 	 * @return `true` if the model was sucessfully created, `false` otherwise.
 	 */
-	bool create(const TriangleMesh* mesh);
+	bool create(const TriangleMesh* mesh, bool smoothNormals = false, std::size_t levelCount = 0);
 	
 	/**
 	 * Creates a model instance of this model.
@@ -117,12 +139,26 @@ public:
 	void setSkeleton(Skeleton* skeleton);
 	
 	/**
-	 * Sets the bounds of this model.
+	 * Sets the bounds of this model. Also resets the bounding sphere and oriented bounds of this model to volumes which contain the bounds, so tighter volumes must be set afterwards.
 	 *
 	 * @param bounds Specifies the model bounds.
 	 */
 	void setBounds(const AABB& bounds);
 	
+	/**
+	 * Sets the bounding sphere of this model, which should be no larger than necessary to contain the model geometry.
+	 *
+	 * @param sphere Specifies the bounding sphere.
+	 */
+	void setBoundingSphere(const Sphere& sphere);
+	
+	/**
+	 * Sets the oriented bounds of this model, which should be no larger than necessary to contain the model geometry.
+	 *
+	 * @param bounds Specifies the oriented bounds.
+	 */
+	void setOrientedBounds(const OBB& bounds);
+	
 	/// Returns the number of model groups in this model.
 	std::size_t getGroupCount() const;
 	
@@ -159,12 +195,39 @@ public:
 	/// Returns the bounds of this model.
 	const AABB& getBounds() const;
 	
+	/// Returns the bounding sphere of this model.
+	const Sphere& getBoundingSphere() const;
+	
+	/// Returns the oriented bounds of this model.
+	const OBB& getOrientedBounds() const;
+	
 private:
-	/// Generates vertex data from a triangle mesh
-	static float* generateVertexData(const TriangleMesh* mesh);
+	/**
+	 * Generates welded vertex data and index data from a triangle mesh. The corners around each vertex are gathered by walking its one-ring of half-edges, and corners with equal normals share one vertex.
+	 *
+	 * @param mesh Specifies the triangle mesh.
+	 * @param smoothNormals Specifies whether the corners of each one-ring should share an averaged normal.
+	 * @param[out] vertexData Interleaved vertex positions and normals.
+	 * @param[out] indexData Three vertex indices per triangle.
+	 */
+	static void generateVertexData(const TriangleMesh* mesh, bool smoothNormals, std::vector<float>* vertexData, std::vector<std::uint32_t>* indexData);
+	
+	/**
+	 * Reorders triangles to improve post-transform vertex cache hit rates, using Tom Forsyth's linear-speed vertex cache optimization.
+	 *
+	 * @param indexData Index data to reorder.
+	 * @param vertexCount Number of vertices referred to by the index data.
+	 */
+	static void optimizeVertexCache(std::vector<std::uint32_t>* indexData, std::size_t vertexCount);
 	
-	/// Generates index data from a triangle mesh
-	static std::uint32_t* generateIndexData(const TriangleMesh* mesh);
+	/**
+	 * Reorders vertices in the order in which they are first referenced by the index data, and remaps the index data accordingly. Vertices which are not referenced are discarded.
+	 *
+	 * @param vertexData Vertex data to reorder.
+	 * @param indexData Index data to remap.
+	 * @param vertexSize Number of floats per vertex.
+	 */
+	static void optimizeVertexFetch(std::vector<float>* vertexData, std::vector<std::uint32_t>* indexData, std::size_t vertexSize);
 	
 	std::vector<Model::Group*> groups;
 	std::map<std::string, Model::Group*> groupMap;
@@ -174,6 +237,8 @@ private:
 	GLuint ibo;
 	Skeleton* skeleton;
 	AABB bounds;
+	Sphere boundingSphere;
+	OBB orientedBounds;
 };
 
 inline std::size_t Model::getGroupCount() const
@@ -226,6 +291,16 @@ inline const AABB& Model::getBounds() const
 	return bounds;
 }
 
+inline const Sphere& Model::getBoundingSphere() const
+{
+	return boundingSphere;
+}
+
+inline const OBB& Model::getOrientedBounds() const
+{
+	return orientedBounds;
+}
+
 } // namespace Emergent
 
 #endif // EMERGENT_GRAPHICS_MODEL_HPP
@@ -22,9 +22,14 @@
 
 #include <emergent/graphics/gl3w.hpp>
 #include <emergent/graphics/shader.hpp>
+#include <emergent/graphics/uniform-buffer.hpp>
+#include <emergent/geometry/occlusion-buffer.hpp>
 #include <emergent/math/types.hpp>
+#include <algorithm>
+#include <cstdint>
 #include <list>
 #include <map>
+#include <vector>
 
 namespace Emergent
 {
@@ -39,8 +44,8 @@ class BillboardBatch;
 
 /*
 1. Scene containing objects (cameras, lights, geometry) is passed to Renderer::render()
-2. Renderer gathers active cameras and forms the lighting state
-3. For each camera, the scene is queried for visibile geometry
+2. Renderer gathers active cameras and forms the lighting state, which is written to the light uniform buffer
+3. For each camera, the camera uniform buffer is written and the scene is queried for visibile geometry
 4. Visibile geometry is sorted into a render queue of render operations
 5. For each render pass of the camera, render operations are passed to RenderPass::render()
 (Steps 6 and 7 may vary for post-processng passes, which simply use a fullscreen quad)
@@ -75,8 +80,30 @@ struct RenderOperation
 	glm::mat4 transform;
 	const Pose* pose;
 	float depth;
+	std::uint64_t key;
+	
+	/// Index of the transform of the operation's first instance in the instance transforms of the render queue
+	std::size_t instanceOffset;
+	
+	/// Number of instances drawn by the operation
+	std::size_t instanceCount;
 };
 
+/**
+ * Packs the sort key of a render operation. Sorting operations by key groups them by layer, then by shader permutation, material, and vertex array, and finally orders them by depth, so that state changes are minimized while nearby geometry is still drawn first. From most to least significant, the key holds 4 bits of layer, 12 bits of permutation, a 16-bit hash of the material, the low 16 bits of the vertex array name, and 16 bits of depth quantized logarithmically.
+ *
+ * @param layer Layer of the operation, such as a render pass index or a transparency class. Only the low 4 bits are used.
+ * @param permutation Shader permutation of the operation. Only the low 12 bits are used.
+ * @param material Material of the operation.
+ * @param vao Vertex array object of the operation.
+ * @param depth Distance of the operation from the camera. Negative depths are treated as zero.
+ * @param backToFront Whether more distant operations should sort first, as for translucent geometry.
+ * @return Sort key of the operation.
+ *
+ * @ingroup graphics
+ */
+std::uint64_t makeRenderKey(std::uint32_t layer, std::uint32_t permutation, const Material* material, GLuint vao, float depth, bool backToFront = false);
+
 /**
  * A list of objects which should be rendered.
  *
@@ -85,48 +112,113 @@ struct RenderOperation
 class RenderQueue
 {
 public:
+	RenderQueue();
+	
+	/**
+	 * Sets the camera for which operations are queued. Model instances are queued at the level of detail which matches their projected size in the view of this camera, or at full detail if no camera is set.
+	 *
+	 * @param camera Pointer to the camera, or `nullptr`.
+	 */
+	void setCamera(const Camera* camera);
+	
 	void queue(const SceneObject* object);
 	void queue(const ModelInstance* instance);
 	void queue(const BillboardBatch* batch);	
 	void queue(const RenderOperation& op);
 	
 	/**
-	 * Sorts operations in the render queue according to the specified comparison function object.
+	 * Sorts operations in the render queue according to the specified comparison function object. Operations which compare equal keep their relative order.
 	 *
 	 * @param compare Comparison function object.
 	 */
 	template <typename T>
 	void sort(T compare);
+
+	/**
+	 * Sorts operations in the render queue by their keys, using a radix sort. Operations with equal keys keep their relative order.
+	 *
+	 * @see makeRenderKey()
+	 */
+	void sort();
+	
+	/**
+	 * Merges operations which draw the same index range of the same vertex array, with the same material and pose, into single instanced operations. Only operations with equal layers, permutations, materials, and vertex arrays in their sort keys are merged, so this should be called after sorting. Each merged operation takes the place of its first operation, and the transforms of its instances are stored contiguously in the instance transforms, starting at its instance offset. Operations which are not merged are given a single instance.
+	 */
+	void instance();
 	
 	/**
-	 * Removes all operations from the render queue.
+	 * Removes all operations from the render queue. Storage is kept for reuse by subsequent frames.
 	 */
 	void clear();
 	
-	const std::list<RenderOperation>* getOperations() const;
+	const std::vector<RenderOperation>* getOperations() const;
+	
+	std::vector<RenderOperation>* getOperations();
 	
-	std::list<RenderOperation>* getOperations();
+	/// Returns the instance transforms of the operations, which are filled by instance().
+	const std::vector<Matrix4>* getInstanceTransforms() const;
 
 private:
-	std::list<RenderOperation> operations;
+	/// Returns the projected size of a scene object's bounds, as a fraction of the viewport height.
+	float calculateScreenSize(const SceneObject* object) const;
+	
+	/// Sort key of an operation, paired with the index of the operation.
+	struct SortEntry
+	{
+		std::uint64_t key;
+		std::uint32_t index;
+	};
+	
+	/// Returns `true` if two operations can be drawn as instances of a single operation.
+	static bool isInstanceOf(const RenderOperation& lhs, const RenderOperation& rhs);
+	
+	const Camera* camera;
+	std::vector<RenderOperation> operations;
+	std::vector<RenderOperation> sortedOperations;
+	std::vector<SortEntry> sortEntries;
+	std::vector<SortEntry> sortBuffer;
+	std::vector<Matrix4> instanceTransforms;
+	std::vector<std::size_t> batchFirsts;
+	std::vector<std::size_t> batchOffsets;
+	std::vector<std::size_t> batchIndices;
 };
 
 template <typename T>
 void RenderQueue::sort(T compare)
 {
-	operations.sort(compare);
+	std::stable_sort(operations.begin(), operations.end(), compare);
+}
+
+inline void RenderQueue::setCamera(const Camera* camera)
+{
+	this->camera = camera;
 }
 
-inline const std::list<RenderOperation>* RenderQueue::getOperations() const
+inline const std::vector<RenderOperation>* RenderQueue::getOperations() const
 {
 	return &operations;
 }
 
-inline std::list<RenderOperation>* RenderQueue::getOperations()
+inline std::vector<RenderOperation>* RenderQueue::getOperations()
 {
 	return &operations;
 }
 
+inline const std::vector<Matrix4>* RenderQueue::getInstanceTransforms() const
+{
+	return &instanceTransforms;
+}
+
+/**
+ * Points the instance transform vertex attribute of the bound vertex array to the transforms of a render operation's instances, so that drawing the operation with glDrawElementsInstanced() gives each instance its own transform. The attribute occupies the four locations starting at `EMERGENT_VERTEX_INSTANCE_TRANSFORM`, one per matrix column.
+ *
+ * @param instanceBuffer Buffer which holds the instance transforms of the render queue.
+ * @param instanceOffset Instance offset of the render operation.
+ *
+ * @ingroup graphics
+ */
+void bindInstanceTransforms(GLuint instanceBuffer, std::size_t instanceOffset);
+
 /**
  * Information required by a render pass.
  *
@@ -143,6 +235,9 @@ public:
 	
 	/// Pointer to the loaded render queue
 	RenderQueue* queue;
+	
+	/// Buffer which holds the instance transforms of the render queue, or `0` if instancing is disabled
+	GLuint instanceBuffer;
 };
 
 /**
@@ -260,6 +355,8 @@ inline RenderPass* Compositor::getPass(std::size_t index)
 /**
  * Renders scenes using their respective cameras.
  *
+ * Camera and light data is written to uniform buffers once per camera and once per frame, respectively, and bound to the binding points of the `CameraBlock` and `LightBlock` uniform blocks, so render passes need not upload it to each shader.
+ *
  * @ingroup graphics
  */
 class Renderer
@@ -269,12 +366,88 @@ public:
 	~Renderer();
 	
 	void render(const Scene& scene);
+
+	/**
+	 * Enables or disables occlusion culling. When enabled, the occluder meshes of objects which pass frustum culling are rasterized into the occlusion buffer, and objects whose bounds are hidden behind them are not rendered. Occlusion culling is skipped for cameras with culling masks, and for objects with culling masks.
+	 *
+	 * @param enabled Whether to enable occlusion culling.
+	 */
+	void setOcclusionCullingEnabled(bool enabled);
+
+	/// Returns `true` if occlusion culling is enabled.
+	bool isOcclusionCullingEnabled() const;
+
+	/// Returns the occlusion buffer, which may be resized to trade culling accuracy for speed.
+	const OcclusionBuffer* getOcclusionBuffer() const;
+
+	/// @copydoc Renderer::getOcclusionBuffer() const
+	OcclusionBuffer* getOcclusionBuffer();
+	
+	/**
+	 * Enables or disables instancing. When enabled, sorted render operations which draw the same geometry with the same material and pose are merged into instanced operations, whose transforms are streamed into the instance buffer of the render context. Render passes must then draw `instanceCount` instances of each operation.
+	 *
+	 * @param enabled Whether to enable instancing.
+	 *
+	 * @see RenderQueue::instance()
+	 * @see bindInstanceTransforms()
+	 */
+	void setInstancingEnabled(bool enabled);
+	
+	/// Returns `true` if instancing is enabled.
+	bool isInstancingEnabled() const;
 	
 private:
+	/// Fills the light block with the active lights of a scene and uploads it.
+	void updateLightBlock(const Scene& scene);
+	
+	/// Fills the camera block with the matrices of a camera and uploads it.
+	void updateCameraBlock(const Camera& camera);
+	
 	RenderQueue renderQueue;
 	RenderContext renderContext;
+	std::vector<float> cullingBounds;
+	std::vector<std::uint32_t> cullingVisibility;
+	std::vector<SceneObject*> visibleObjects;
+	bool occlusionCullingEnabled;
+	OcclusionBuffer occlusionBuffer;
+	CameraBlock cameraBlock;
+	LightBlock lightBlock;
+	UniformBuffer cameraUniformBuffer;
+	UniformBuffer lightUniformBuffer;
+	bool instancingEnabled;
+	GLuint instanceBuffer;
 };
 
+inline void Renderer::setOcclusionCullingEnabled(bool enabled)
+{
+	this->occlusionCullingEnabled = enabled;
+}
+
+inline bool Renderer::isOcclusionCullingEnabled() const
+{
+	return occlusionCullingEnabled;
+}
+
+inline const OcclusionBuffer* Renderer::getOcclusionBuffer() const
+{
+	return &occlusionBuffer;
+}
+
+inline OcclusionBuffer* Renderer::getOcclusionBuffer()
+{
+	return &occlusionBuffer;
+}
+
+inline void Renderer::setInstancingEnabled(bool enabled)
+{
+	this->instancingEnabled = enabled;
+}
+
+inline bool Renderer::isInstancingEnabled() const
+{
+	return instancingEnabled;
+}
+
 } // namespace Emergent
 
 #endif // EMERGENT_GRAPHICS_RENDERER_HPP
@@ -28,6 +28,8 @@
 namespace Emergent
 {
 
+class TriangleMesh;
+
 /**
  * Enumerates the scene object types.
  *
@@ -55,6 +57,13 @@ public:
 	void setActive(bool active);
 	void setCullingEnabled(bool enabled);
 	void setCullingMask(const BoundingVolume* mask);
+
+	/**
+	 * Sets a simplified mesh which the renderer rasterizes into its occlusion buffer to hide objects behind this one. The mesh is specified in object space and should lie within the visible surface of the object.
+	 *
+	 * @param occluder Pointer to the occluder mesh, or `nullptr` if this object should not hide other objects.
+	 */
+	void setOccluder(const TriangleMesh* occluder);
 	void setTransform(const Transform& transform);
 	void setTranslation(const Vector3& translation);
 	void setRotation(const Quaternion& rotation);
@@ -101,6 +110,9 @@ public:
 	/// Returns the culling mask of this object
 	const BoundingVolume* getCullingMask() const;
 
+	/// Returns the occluder mesh of this object
+	const TriangleMesh* getOccluder() const;
+
 	/// Returns a list of tweens used by this object
 	const std::list<TweenBase*>* getTweens() const;
 
@@ -171,6 +183,7 @@ private:
 	bool active;
 	bool cullingEnabled;
 	const BoundingVolume* cullingMask;
+	const TriangleMesh* occluder;
 	AABB bounds;
 	Transform transform;
 	Vector3 forward;
@@ -201,6 +214,11 @@ inline void SceneObject::setCullingMask(const BoundingVolume* mask)
 	this->cullingMask = mask;
 }
 
+inline void SceneObject::setOccluder(const TriangleMesh* occluder)
+{
+	this->occluder = occluder;
+}
+
 inline bool SceneObject::isActive() const
 {
 	return active;
@@ -216,6 +234,11 @@ inline const BoundingVolume* SceneObject::getCullingMask() const
 	return cullingMask;
 }
 
+inline const TriangleMesh* SceneObject::getOccluder() const
+{
+	return occluder;
+}
+
 inline const AABB& SceneObject::getBounds() const
 {
 	return bounds;
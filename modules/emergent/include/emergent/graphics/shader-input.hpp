@@ -22,6 +22,7 @@
 
 #include <emergent/graphics/gl3w.hpp>
 #include <emergent/math/types.hpp>
+#include <cstdint>
 #include <string>
 
 namespace Emergent
@@ -134,6 +135,14 @@ private:
 	 */
 	~ShaderInput();
 	
+	/**
+	 * Marks the value of the uniform as unknown, so that the next shader variable upload will not be skipped.
+	 */
+	void forgetUploadedVersion() const;
+	
+	/// Uploaded version which indicates a sampler uniform has been set to its texture unit
+	static const std::uint64_t samplerVersion = ~static_cast<std::uint64_t>(0);
+	
 	Shader* shader;
 	std::size_t inputIndex;
 	GLint uniformLocation;
@@ -141,6 +150,9 @@ private:
 	ShaderVariableType dataType;
 	std::size_t elementCount;
 	int textureUnit;
+	
+	/// Points to the active permutation's record of the shader variable version last uploaded through this input
+	std::uint64_t* uploadedVersion;
 };
 
 inline ShaderVariableType ShaderInput::getDataType() const
@@ -158,6 +170,14 @@ inline std::size_t ShaderInput::getElementCount() const
 	return elementCount;
 }
 
+inline void ShaderInput::forgetUploadedVersion() const
+{
+	if (uploadedVersion != nullptr)
+	{
+		*uploadedVersion = 0;
+	}
+}
+
 } // namespace Emergent
 
 #endif // EMERGENT_GRAPHICS_SHADER_INPUT_HPP
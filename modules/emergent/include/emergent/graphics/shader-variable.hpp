@@ -93,6 +93,11 @@ public:
 	 */
 	const ShaderInput* getConnectedInput() const;
 	
+	/**
+	 * Returns the version of the variable's value. The version changes every time the value is modified, and is unique across all shader variables.
+	 */
+	std::uint64_t getVersion() const;
+	
 	/**
 	 * Transmits the value of this shader variable to the connected shader input.
 	 *
@@ -109,7 +114,16 @@ public:
 
 	
 protected:
+	/**
+	 * Assigns a new version to the variable's value. Must be called whenever the value is modified.
+	 */
+	void updateVersion();
+	
 	const ShaderInput* connectedInput;
+	std::uint64_t version;
+	
+private:
+	static std::uint64_t versionCounter;
 };
 
 inline bool ShaderVariableBase::isConnected() const
@@ -122,6 +136,16 @@ inline const ShaderInput* ShaderVariableBase::getConnectedInput() const
 	return connectedInput;
 }
 
+inline std::uint64_t ShaderVariableBase::getVersion() const
+{
+	return version;
+}
+
+inline void ShaderVariableBase::updateVersion()
+{
+	version = ++versionCounter;
+}
+
 /**
  * Contains data which can be passed to a shader via a shader input.
  *
@@ -242,26 +266,46 @@ bool ShaderVariable<T>::upload() const
 		return false;
 	}
 	
+	// Texture variables are always uploaded, as texture unit bindings are not part of the shader program state
+	bool texture = (getDataType() == ShaderVariableType::TEXTURE_2D || getDataType() == ShaderVariableType::TEXTURE_CUBE);
+	
+	// Skip the upload if this version of the value was the last to be uploaded to the uniform
+	std::uint64_t* uploadedVersion = connectedInput->uploadedVersion;
+	if (!texture && uploadedVersion != nullptr && *uploadedVersion == version)
+	{
+		return true;
+	}
+	
+	bool uploaded;
 	if (elementCount > 1)
 	{
-		return connectedInput->upload(0, values, elementCount);
+		uploaded = connectedInput->upload(0, values, elementCount);
 	}
 	else
 	{
-		return connectedInput->upload(values[0]);
+		uploaded = connectedInput->upload(values[0]);
 	}
+	
+	if (!texture && uploaded && uploadedVersion != nullptr)
+	{
+		*uploadedVersion = version;
+	}
+	
+	return uploaded;
 }
 
 template <typename T>
 inline void ShaderVariable<T>::setValue(const T& value)
 {
 	this->values[0] = value;
+	updateVersion();
 }
 
 template <typename T>
 inline void ShaderVariable<T>::setValue(std::size_t index, const T& value)
 {
 	this->values[index] = value;
+	updateVersion();
 }
 
 template <typename T>
@@ -271,6 +315,7 @@ inline void ShaderVariable<T>::setValues(std::size_t index, const T* values, std
 	{
 		this->values[index + i] = values[i];
 	}
+	updateVersion();
 }
 
 template <typename T>
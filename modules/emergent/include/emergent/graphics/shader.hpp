@@ -65,6 +65,9 @@ public:
 	GLuint geometryShader;
 	GLuint fragmentShader;
 	std::vector<GLint> uniformLocations;
+	
+	/// Version of the shader variable value last uploaded to each uniform, or `0` if unknown
+	std::vector<std::uint64_t> uploadedVersions;
 };
 
 /**
@@ -196,6 +199,13 @@ private:
 	 */
 	void reevaluateInputs(ShaderPermutation* permutation);
 	
+	/**
+	 * Binds the uniform blocks of a shader permutation to the binding points of the uniform buffers which back them.
+	 *
+	 * @see findUniformBlockBinding()
+	 */
+	void bindUniformBlocks(ShaderPermutation* permutation);
+	
 	/**
 	 * Reroutes shader inputs to the uniform locations of the active shader permutation.
 	 */
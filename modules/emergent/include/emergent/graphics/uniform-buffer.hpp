@@ -0,0 +1,193 @@
+/*
+ * Copyright (C) 2017-2019  Christopher J. Howard
+ *
+ * This file is part of Emergent.
+ *
+ * Emergent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Emergent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Emergent.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef EMERGENT_GRAPHICS_UNIFORM_BUFFER_HPP
+#define EMERGENT_GRAPHICS_UNIFORM_BUFFER_HPP
+
+#include <emergent/graphics/gl3w.hpp>
+#include <emergent/math/types.hpp>
+#include <cstdint>
+#include <string>
+
+namespace Emergent
+{
+
+/**
+ * A buffer object which holds the data of a uniform block. The buffer is bound to a fixed binding point, so that every shader which declares the block reads the same data without uploading it through shader inputs.
+ *
+ * The buffer object is created on the first update, so a uniform buffer may be constructed before an OpenGL context exists.
+ *
+ * @ingroup graphics
+ */
+class UniformBuffer
+{
+public:
+	/**
+	 * Creates a uniform buffer.
+	 *
+	 * @param bindingPoint Index of the uniform buffer binding point to which the buffer is bound.
+	 */
+	explicit UniformBuffer(GLuint bindingPoint);
+	
+	/**
+	 * Destroys a uniform buffer and deletes its buffer object.
+	 */
+	~UniformBuffer();
+	
+	/**
+	 * Replaces the contents of the buffer and binds it to its binding point.
+	 *
+	 * @param data Pointer to the data of the uniform block, laid out according to the `std140` rules.
+	 * @param size Size of the data, in bytes.
+	 */
+	void update(const void* data, std::size_t size);
+	
+	/**
+	 * Binds the buffer to its binding point.
+	 */
+	void bind() const;
+	
+	/// Returns the index of the binding point to which the buffer is bound.
+	GLuint getBindingPoint() const;
+	
+	/// Returns the name of the buffer object, or `0` if the buffer has not been updated.
+	GLuint getBufferID() const;
+	
+private:
+	UniformBuffer(const UniformBuffer&) = delete;
+	UniformBuffer& operator=(const UniformBuffer&) = delete;
+	
+	GLuint bindingPoint;
+	GLuint buffer;
+};
+
+inline GLuint UniformBuffer::getBindingPoint() const
+{
+	return bindingPoint;
+}
+
+inline GLuint UniformBuffer::getBufferID() const
+{
+	return buffer;
+}
+
+/**
+ * Per-camera data of the `CameraBlock` uniform block, which the renderer updates once for each camera before its compositor runs. Shaders access the data by declaring the block as follows:
+ *
+ * ```
+ * layout(std140) uniform CameraBlock
+ * {
+ *     mat4 view;
+ *     mat4 projection;
+ *     mat4 viewProjection;
+ *     mat4 inverseView;
+ *     mat4 inverseProjection;
+ *     mat4 inverseViewProjection;
+ *     vec4 cameraPosition;
+ *     vec4 cameraClip;
+ * };
+ * ```
+ *
+ * @ingroup graphics
+ */
+struct CameraBlock
+{
+	/// Uniform buffer binding point of the block
+	static const GLuint bindingPoint = 0;
+	
+	Matrix4 view;
+	Matrix4 projection;
+	Matrix4 viewProjection;
+	Matrix4 inverseView;
+	Matrix4 inverseProjection;
+	Matrix4 inverseViewProjection;
+	
+	/// World-space position of the camera in `xyz`
+	Vector4 position;
+	
+	/// Near and far clipping distances of the camera in `x` and `y`
+	Vector4 clip;
+};
+
+/**
+ * Per-frame data of the `LightBlock` uniform block, which the renderer updates once per frame from the active lights of the scene. Positions and directions are in world space, colors are scaled by light intensities, and lights in excess of the maximum count of their type are ignored. Shaders access the data by declaring the block as follows:
+ *
+ * ```
+ * layout(std140) uniform LightBlock
+ * {
+ *     ivec4 lightCounts;
+ *     vec4 pointLightPosition[8];
+ *     vec4 pointLightColor[8];
+ *     vec4 pointLightAttenuation[8];
+ *     vec4 directionalLightDirection[4];
+ *     vec4 directionalLightColor[4];
+ *     vec4 spotlightPosition[4];
+ *     vec4 spotlightColor[4];
+ *     vec4 spotlightAttenuation[4];
+ *     vec4 spotlightDirection[4];
+ * };
+ * ```
+ *
+ * @ingroup graphics
+ */
+struct LightBlock
+{
+	/// Uniform buffer binding point of the block
+	static const GLuint bindingPoint = 1;
+	
+	static const std::size_t maxPointLights = 8;
+	static const std::size_t maxDirectionalLights = 4;
+	static const std::size_t maxSpotlights = 4;
+	
+	/// Numbers of point lights, directional lights, and spotlights in `x`, `y`, and `z`
+	std::int32_t counts[4];
+	
+	Vector4 pointLightPositions[maxPointLights];
+	Vector4 pointLightColors[maxPointLights];
+	Vector4 pointLightAttenuations[maxPointLights];
+	
+	Vector4 directionalLightDirections[maxDirectionalLights];
+	Vector4 directionalLightColors[maxDirectionalLights];
+	
+	Vector4 spotlightPositions[maxSpotlights];
+	Vector4 spotlightColors[maxSpotlights];
+	
+	/// Spotlight attenuations in `xyz`, and spotlight exponents in `w`
+	Vector4 spotlightAttenuations[maxSpotlights];
+	
+	/// Spotlight directions in `xyz`, and cosines of spotlight cutoff angles in `w`
+	Vector4 spotlightDirections[maxSpotlights];
+};
+
+/**
+ * Finds the uniform buffer binding point of a uniform block declared by a shader.
+ *
+ * @param blockName Name of the uniform block, such as `CameraBlock`.
+ * @param[out] bindingPoint Index of the binding point of the block.
+ * @return `true` if the block is one of the blocks provided by the engine, `false` otherwise.
+ *
+ * @ingroup graphics
+ */
+bool findUniformBlockBinding(const std::string& blockName, GLuint* bindingPoint);
+
+} // namespace Emergent
+
+#endif // EMERGENT_GRAPHICS_UNIFORM_BUFFER_HPP
+
@@ -31,6 +31,7 @@ namespace Emergent
 #define EMERGENT_VERTEX_BONE_INDICES 5
 #define EMERGENT_VERTEX_BONE_WEIGHTS 6
 #define EMERGENT_VERTEX_COLOR 7
+#define EMERGENT_VERTEX_INSTANCE_TRANSFORM 8 // Occupies locations 8 through 11
 
 } // namespace Emergent
 
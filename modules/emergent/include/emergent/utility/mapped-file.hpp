@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2017-2019  Christopher J. Howard
+ *
+ * This file is part of Emergent.
+ *
+ * Emergent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Emergent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Emergent.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef EMERGENT_UTILITY_MAPPED_FILE_HPP
+#define EMERGENT_UTILITY_MAPPED_FILE_HPP
+
+#include <cstdlib>
+#include <string>
+
+namespace Emergent
+{
+
+/**
+ * Read-only memory-mapped file. The contents of the file are paged in by the OS as they are accessed, rather than read up front.
+ *
+ * @ingroup utility
+ */
+class MappedFile
+{
+public:
+	/**
+	 * Creates an instance of MappedFile.
+	 */
+	MappedFile();
+	
+	/**
+	 * Destroys an instance of MappedFile, unmapping its file.
+	 */
+	~MappedFile();
+	
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	
+	/**
+	 * Maps a file into memory, unmapping any previously mapped file. The mapping is aligned to a page boundary.
+	 *
+	 * @param filename Specifies the path of the file to map.
+	 * @return `true` if the file was successfully mapped, `false` otherwise.
+	 */
+	bool open(const std::string& filename);
+	
+	/**
+	 * Unmaps the mapped file, if any.
+	 */
+	void close();
+	
+	/// Returns `true` if a file is mapped, `false` otherwise.
+	bool isOpen() const;
+	
+	/// Returns a pointer to the contents of the mapped file, or `nullptr` if no file is mapped.
+	const void* getData() const;
+	
+	/// Returns the size of the mapped file, in bytes.
+	std::size_t getSize() const;
+	
+private:
+	const void* data;
+	std::size_t size;
+};
+
+inline bool MappedFile::isOpen() const
+{
+	return data != nullptr;
+}
+
+inline const void* MappedFile::getData() const
+{
+	return data;
+}
+
+inline std::size_t MappedFile::getSize() const
+{
+	return size;
+}
+
+} // namespace Emergent
+
+#endif // EMERGENT_UTILITY_MAPPED_FILE_HPP
+
@@ -20,6 +20,7 @@
 #include <emergent/font/font.hpp>
 #include <emergent/font/texture-packer.hpp>
 #include <emergent/graphics/billboard.hpp>
+#include <emergent/graphics/gl-state.hpp>
 #include <emergent/utility/unicode.hpp>
 #include <iostream>
 
@@ -32,7 +33,7 @@ Font::Font(const FontMetrics& metrics, unsigned int width, unsigned int height):
 	GLuint textureID;
 	
 	glGenTextures(1, &textureID);
-	glBindTexture(GL_TEXTURE_2D, textureID);
+	GLState::bindTexture(0, GL_TEXTURE_2D, textureID);
 	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
 	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST);
@@ -66,7 +67,7 @@ bool Font::addGlyph(char32_t charcode, const GlyphMetrics& metrics, const unsign
 	
 	const Rect& rect = node->getBounds();
 	
-	glBindTexture(GL_TEXTURE_2D, texture.getTextureID());
+	GLState::bindTexture(0, GL_TEXTURE_2D, texture.getTextureID());
 	
 	// Update texture
 	glPixelStorei(GL_PACK_ALIGNMENT, 1);
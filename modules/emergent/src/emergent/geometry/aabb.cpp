@@ -19,6 +19,7 @@
 
 #include <emergent/geometry/aabb.hpp>
 #include <emergent/geometry/sphere.hpp>
+#include <emergent/geometry/obb.hpp>
 #include <algorithm>
 
 namespace Emergent
@@ -34,52 +35,38 @@ void AABB::add(const Vector3& v)
 	maxPoint.z = std::max(maxPoint.z, v.z);
 }
 
-AABB AABB::transformed(const Matrix4& m) const
+/**
+ * Transforms a box by an affine transformation using Arvo's method. Each component of the transformed box is the translation plus, for every column of the linear part, the smaller or larger of that column applied to the minimum and maximum points. This bounds the same eight corners as transforming each corner individually, at a fraction of the cost.
+ */
+static AABB transformAffine(const Matrix3& m, const Vector3& translation, const Vector3& minPoint, const Vector3& maxPoint)
 {
-	Vector3 corners[7] =
-	{
-		Vector3(minPoint.x, minPoint.y, maxPoint.z),
-		Vector3(minPoint.x, maxPoint.y, minPoint.z),
-		Vector3(minPoint.x, maxPoint.y, maxPoint.z),
-		Vector3(maxPoint.x, minPoint.y, minPoint.z),
-		Vector3(maxPoint.x, minPoint.y, maxPoint.z),
-		Vector3(maxPoint.x, maxPoint.y, minPoint.z),
-		maxPoint
-	};
+	Vector3 resultMin = translation;
+	Vector3 resultMax = translation;
 	
-	Vector3 transformedCorner = Vector3(m * Vector4(minPoint, 1.0f));
-	AABB result(transformedCorner, transformedCorner);
-	for (std::size_t i = 0; i < 7; ++i)
+	for (int j = 0; j < 3; ++j)
 	{
-		transformedCorner = Vector3(m * Vector4(corners[i], 1.0f));
-		result.add(transformedCorner);
+		Vector3 a = m[j] * minPoint[j];
+		Vector3 b = m[j] * maxPoint[j];
+		resultMin += glm::min(a, b);
+		resultMax += glm::max(a, b);
 	}
 	
-	return result;
+	return AABB(resultMin, resultMax);
+}
+
+AABB AABB::transformed(const Matrix4& m) const
+{
+	return transformAffine(Matrix3(m), Vector3(m[3]), minPoint, maxPoint);
 }
 
 AABB AABB::transformed(const Transform& transform) const
 {
-	Vector3 corners[7] =
-	{
-		Vector3(minPoint.x, minPoint.y, maxPoint.z),
-		Vector3(minPoint.x, maxPoint.y, minPoint.z),
-		Vector3(minPoint.x, maxPoint.y, maxPoint.z),
-		Vector3(maxPoint.x, minPoint.y, minPoint.z),
-		Vector3(maxPoint.x, minPoint.y, maxPoint.z),
-		Vector3(maxPoint.x, maxPoint.y, minPoint.z),
-		maxPoint
-	};
-	
-	Vector3 transformedCorner = transform.transform(minPoint);
-	AABB result(transformedCorner, transformedCorner);
-	for (std::size_t i = 0; i < 7; ++i)
-	{
-		transformedCorner = transform.transform(corners[i]);
-		result.add(transformedCorner);
-	}
+	Matrix3 m = glm::mat3_cast(transform.rotation);
+	m[0] *= transform.scale.x;
+	m[1] *= transform.scale.y;
+	m[2] *= transform.scale.z;
 	
-	return result;
+	return transformAffine(m, transform.translation, minPoint, maxPoint);
 }
 
 bool AABB::intersects(const Sphere& sphere) const
@@ -98,6 +85,11 @@ bool AABB::intersects(const AABB& aabb) const
 	return true;
 }
 
+bool AABB::intersects(const OBB& obb) const
+{
+	return obb.intersects(*this);
+}
+
 bool AABB::contains(const Vector3& point) const
 {
 	if (point.x < minPoint.x || point.x > maxPoint.x)
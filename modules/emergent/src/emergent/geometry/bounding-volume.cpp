@@ -19,6 +19,7 @@
 
 #include <emergent/geometry/bounding-volume.hpp>
 #include <emergent/geometry/aabb.hpp>
+#include <emergent/geometry/obb.hpp>
 #include <emergent/geometry/sphere.hpp>
 #include <emergent/geometry/convex-hull.hpp>
 #include <stdexcept>
@@ -39,6 +40,10 @@ bool BoundingVolume::intersects(const BoundingVolume& volume) const
 			return intersects(static_cast<const Sphere&>(volume));
 			break;
 
+		case BoundingVolume::Type::OBB:
+			return intersects(static_cast<const OBB&>(volume));
+			break;
+
 		default:
 			throw std::runtime_error("unimplemented");
 			break;
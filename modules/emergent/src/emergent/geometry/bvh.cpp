@@ -0,0 +1,741 @@
+/*
+ * Copyright (C) 2017-2019  Christopher J. Howard
+ *
+ * This file is part of Emergent.
+ *
+ * Emergent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Emergent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Emergent.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <emergent/geometry/bvh.hpp>
+#include <emergent/geometry/triangle-mesh.hpp>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace Emergent
+{
+
+/// Number of bins evaluated per axis when searching for a split
+static const std::size_t binCount = 12;
+
+/// Leaf nodes are always created for ranges containing at most this number of triangles, which fills a single packet
+static const std::uint32_t minLeafSize = 4;
+
+/// Ranges containing more than this number of triangles are always split
+static const std::uint32_t maxLeafSize = 8;
+
+/// Maximum depth of the hierarchy, which bounds the size of the traversal stack
+static const std::size_t maxDepth = 63;
+
+/// Number of nodes the traversal stack can hold. Traversals skip the children of nodes which would overflow it, which only happens for corrupt images loaded without verification.
+static const std::size_t stackCapacity = maxDepth + 1;
+
+/**
+ * Calculates half the surface area of a box.
+ */
+static inline float halfSurfaceArea(const Vector3& min, const Vector3& max)
+{
+	Vector3 extents = max - min;
+	return extents.x * extents.y + extents.y * extents.z + extents.z * extents.x;
+}
+
+/**
+ * Inverts a component of a ray direction for slab tests. Components whose inverses are infinite, including negative zero, are inverted to positive infinity, which intersectSlab() relies on.
+ */
+static inline float invertComponent(float x)
+{
+	float inverse = 1.0f / x;
+	return (std::isinf(inverse)) ? std::numeric_limits<float>::infinity() : inverse;
+}
+
+/**
+ * Inverts a ray direction for slab tests.
+ */
+static inline Vector3 invertDirection(const Vector3& direction)
+{
+	return Vector3(invertComponent(direction.x), invertComponent(direction.y), invertComponent(direction.z));
+}
+
+/**
+ * Performs a ray-box slab test using a precomputed inverse ray direction.
+ *
+ * A ray which is parallel to a slab and whose origin lies on one of its planes yields `0 * inf = NaN` for that plane, yet stays inside the slab. `std::min()` and `std::max()` return their first operand when compared with NaN, so the accumulated interval is always passed first, and the bounds of each slab are ordered so that such a slab yields NaN, which is then ignored, rather than an infinite bound on the wrong side.
+ *
+ * @param[out] t Returns the distance at which the ray enters the box.
+ * @return `true` if the ray intersects the box within `[0, tmax]`.
+ */
+static inline bool intersectSlab(const BVH::Node& node, const Vector3& origin, const Vector3& inverseDirection, float tmax, float* t)
+{
+	float tx0 = (node.min.x - origin.x) * inverseDirection.x;
+	float tx1 = (node.max.x - origin.x) * inverseDirection.x;
+	float ty0 = (node.min.y - origin.y) * inverseDirection.y;
+	float ty1 = (node.max.y - origin.y) * inverseDirection.y;
+	float tz0 = (node.min.z - origin.z) * inverseDirection.z;
+	float tz1 = (node.max.z - origin.z) * inverseDirection.z;
+
+	float t0 = std::max(std::max(std::max(0.0f, std::min(tx0, tx1)), std::min(ty0, ty1)), std::min(tz0, tz1));
+	float t1 = std::min(std::min(std::min(tmax, std::max(tx1, tx0)), std::max(ty1, ty0)), std::max(tz1, tz0));
+
+	*t = t0;
+	return (t0 <= t1);
+}
+
+/**
+ * Header of a serialized BVH image. Offsets are relative to the start of the image.
+ */
+struct BVHFileHeader
+{
+	std::uint32_t magic;
+	std::uint32_t version;
+	std::uint32_t nodeSize;
+	std::uint32_t packetSize;
+	std::uint64_t size;
+	std::uint64_t triangleCount;
+	std::uint64_t nodeOffset;
+	std::uint64_t nodeCount;
+	std::uint64_t packetOffset;
+	std::uint64_t packetCount;
+	std::uint64_t indexOffset;
+	std::uint32_t checksum;
+	std::uint32_t reserved;
+};
+
+/// Alignment of each array within a serialized BVH image
+static const std::size_t fileAlignment = 64;
+
+/**
+ * Rounds an offset up to the alignment of arrays within a serialized BVH image.
+ */
+static inline std::size_t alignOffset(std::size_t offset)
+{
+	return (offset + fileAlignment - 1) & ~(fileAlignment - 1);
+}
+
+/**
+ * Calculates the CRC-32 checksum of a block of data.
+ */
+static std::uint32_t calculateChecksum(const std::uint8_t* data, std::size_t size)
+{
+	static const std::array<std::uint32_t, 256> table = []()
+	{
+		std::array<std::uint32_t, 256> table;
+		for (std::uint32_t i = 0; i < 256; ++i)
+		{
+			std::uint32_t crc = i;
+			for (int j = 0; j < 8; ++j)
+			{
+				crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320u : crc >> 1;
+			}
+			table[i] = crc;
+		}
+		return table;
+	}();
+
+	std::uint32_t crc = 0xFFFFFFFFu;
+	for (std::size_t i = 0; i < size; ++i)
+	{
+		crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+	}
+
+	return crc ^ 0xFFFFFFFFu;
+}
+
+BVH::BVH():
+	triangleCount(0),
+	nodeData(nullptr),
+	packetData(nullptr),
+	indexData(nullptr),
+	nodeCount(0),
+	packetCount(0)
+{}
+
+BVH::BVH(const TriangleMesh& mesh):
+	BVH()
+{
+	build(mesh);
+}
+
+BVH::BVH(const BVH& other):
+	BVH()
+{
+	*this = other;
+}
+
+BVH& BVH::operator=(const BVH& other)
+{
+	if (this == &other)
+	{
+		return *this;
+	}
+
+	nodes = other.nodes;
+	packets = other.packets;
+	indices = other.indices;
+	triangleCount = other.triangleCount;
+
+	if (other.nodeData == other.nodes.data())
+	{
+		bindArrays();
+	}
+	else
+	{
+		// Refer to the same loaded image
+		nodeData = other.nodeData;
+		packetData = other.packetData;
+		indexData = other.indexData;
+		nodeCount = other.nodeCount;
+		packetCount = other.packetCount;
+	}
+
+	return *this;
+}
+
+void BVH::build(const TriangleMesh& mesh)
+{
+	clear();
+
+	const std::vector<TriangleMesh::Triangle>& triangles = *mesh.getTriangles();
+	std::uint32_t triangleCount = static_cast<std::uint32_t>(triangles.size());
+	if (!triangleCount)
+	{
+		return;
+	}
+
+	// Gather triangle positions, bounds, and centroids
+	std::vector<Vector3> positions(triangleCount * 3);
+	std::vector<Vector3> triangleMin(triangleCount);
+	std::vector<Vector3> triangleMax(triangleCount);
+	std::vector<Vector3> centroids(triangleCount);
+	for (std::uint32_t i = 0; i < triangleCount; ++i)
+	{
+		std::uint32_t edge = TriangleMesh::getEdge(i);
+		const Vector3& a = mesh.getPosition(edge);
+		const Vector3& b = mesh.getPosition(edge + 1);
+		const Vector3& c = mesh.getPosition(edge + 2);
+
+		positions[i * 3] = a;
+		positions[i * 3 + 1] = b;
+		positions[i * 3 + 2] = c;
+		triangleMin[i] = glm::min(a, glm::min(b, c));
+		triangleMax[i] = glm::max(a, glm::max(b, c));
+		centroids[i] = (triangleMin[i] + triangleMax[i]) * 0.5f;
+	}
+
+	// Build hierarchy
+	indices.resize(triangleCount);
+	for (std::uint32_t i = 0; i < triangleCount; ++i)
+	{
+		indices[i] = i;
+	}
+	nodes.reserve(triangleCount * 2 - 1);
+	subdivide(0, triangleCount, 0, triangleMin, triangleMax, centroids);
+	nodes.shrink_to_fit();
+
+	// Copy the triangles of each leaf into packets, and point leaves at their first packet
+	std::vector<std::uint32_t> order;
+	order.swap(indices);
+	for (Node& node: nodes)
+	{
+		if (!node.count)
+		{
+			continue;
+		}
+
+		std::uint32_t first = node.offset;
+		node.offset = static_cast<std::uint32_t>(packets.size());
+
+		for (std::uint32_t i = 0; i < node.count; i += 4)
+		{
+			packets.emplace_back();
+			TrianglePacket<4>& packet = packets.back();
+
+			for (std::uint32_t j = 0; j < 4; ++j)
+			{
+				if (i + j < node.count)
+				{
+					std::uint32_t index = order[first + i + j];
+					packet.set(j, positions[index * 3], positions[index * 3 + 1], positions[index * 3 + 2]);
+					indices.push_back(index);
+				}
+				else
+				{
+					packet.clear(j);
+					indices.push_back(triangleCount);
+				}
+			}
+		}
+	}
+
+	this->triangleCount = triangleCount;
+	bindArrays();
+}
+
+void BVH::clear()
+{
+	nodes.clear();
+	packets.clear();
+	indices.clear();
+	triangleCount = 0;
+	bindArrays();
+}
+
+void BVH::serialize(std::vector<std::uint8_t>* data) const
+{
+	BVHFileHeader header;
+	std::memset(&header, 0, sizeof(header));
+	header.magic = fileMagic;
+	header.version = fileVersion;
+	header.nodeSize = sizeof(Node);
+	header.packetSize = sizeof(TrianglePacket<4>);
+	header.triangleCount = triangleCount;
+	header.nodeCount = nodeCount;
+	header.packetCount = packetCount;
+
+	// Lay out arrays after the header
+	header.nodeOffset = alignOffset(sizeof(BVHFileHeader));
+	header.packetOffset = alignOffset(header.nodeOffset + sizeof(Node) * nodeCount);
+	header.indexOffset = alignOffset(header.packetOffset + sizeof(TrianglePacket<4>) * packetCount);
+	header.size = header.indexOffset + sizeof(std::uint32_t) * packetCount * 4;
+
+	data->assign(header.size, 0);
+	std::uint8_t* image = data->data();
+	if (nodeCount)
+	{
+		std::memcpy(image + header.nodeOffset, nodeData, sizeof(Node) * nodeCount);
+		std::memcpy(image + header.packetOffset, packetData, sizeof(TrianglePacket<4>) * packetCount);
+		std::memcpy(image + header.indexOffset, indexData, sizeof(std::uint32_t) * packetCount * 4);
+	}
+
+	header.checksum = calculateChecksum(image + sizeof(BVHFileHeader), header.size - sizeof(BVHFileHeader));
+	std::memcpy(image, &header, sizeof(BVHFileHeader));
+}
+
+void BVH::load(const void* data, std::size_t size, bool verify)
+{
+	const std::uint8_t* image = static_cast<const std::uint8_t*>(data);
+	if (reinterpret_cast<std::uintptr_t>(image) % alignof(TrianglePacket<4>) != 0)
+	{
+		throw std::runtime_error("BVH::load(): Image is misaligned.");
+	}
+
+	if (size < sizeof(BVHFileHeader))
+	{
+		throw std::runtime_error("BVH::load(): Image is truncated.");
+	}
+
+	BVHFileHeader header;
+	std::memcpy(&header, image, sizeof(BVHFileHeader));
+
+	// Byte-swapped magic numbers are reported as byte order mismatches
+	if (header.magic != fileMagic)
+	{
+		if (header.magic == ((fileMagic >> 24) | ((fileMagic >> 8) & 0xFF00) | ((fileMagic << 8) & 0xFF0000) | (fileMagic << 24)))
+		{
+			throw std::runtime_error("BVH::load(): Image was serialized with another byte order.");
+		}
+		throw std::runtime_error("BVH::load(): Data is not a BVH image.");
+	}
+
+	if (header.version != fileVersion || header.nodeSize != sizeof(Node) || header.packetSize != sizeof(TrianglePacket<4>))
+	{
+		throw std::runtime_error("BVH::load(): Image version is not supported.");
+	}
+
+	// Check that the image holds more than its header and that no array overlaps the header
+	if (header.size < sizeof(BVHFileHeader)
+		|| header.nodeOffset < sizeof(BVHFileHeader) || header.packetOffset < sizeof(BVHFileHeader) || header.indexOffset < sizeof(BVHFileHeader))
+	{
+		throw std::runtime_error("BVH::load(): Image is corrupt.");
+	}
+
+	// Check that each array lies within the image
+	if (header.size > size
+		|| header.nodeOffset % fileAlignment || header.packetOffset % fileAlignment || header.indexOffset % fileAlignment
+		|| header.nodeCount > (header.size - std::min<std::uint64_t>(header.nodeOffset, header.size)) / sizeof(Node)
+		|| header.packetCount > (header.size - std::min<std::uint64_t>(header.packetOffset, header.size)) / sizeof(TrianglePacket<4>)
+		|| header.packetCount > (header.size - std::min<std::uint64_t>(header.indexOffset, header.size)) / (sizeof(std::uint32_t) * 4))
+	{
+		throw std::runtime_error("BVH::load(): Image is truncated.");
+	}
+
+	if (verify && calculateChecksum(image + sizeof(BVHFileHeader), header.size - sizeof(BVHFileHeader)) != header.checksum)
+	{
+		throw std::runtime_error("BVH::load(): Image checksum does not match.");
+	}
+
+	// Check that the nodes form a single tree in depth-first order, no deeper than a built hierarchy, and that leaves refer to packets within the image
+	if (verify)
+	{
+		const Node* imageNodes = reinterpret_cast<const Node*>(image + header.nodeOffset);
+		std::uint64_t pending[maxDepth];
+		std::size_t pendingCount = 0;
+
+		for (std::uint64_t i = 0; i < header.nodeCount; ++i)
+		{
+			const Node& node = imageNodes[i];
+			if (node.count)
+			{
+				if (node.offset + (static_cast<std::uint64_t>(node.count) + 3) / 4 > header.packetCount)
+				{
+					throw std::runtime_error("BVH::load(): Image is corrupt.");
+				}
+
+				// The node following a leaf must be the right child of its nearest ancestor whose right subtree has not been visited
+				std::uint64_t next = (pendingCount) ? pending[--pendingCount] : header.nodeCount;
+				if (next != i + 1)
+				{
+					throw std::runtime_error("BVH::load(): Image is corrupt.");
+				}
+			}
+			else
+			{
+				// The left child immediately follows its parent, so the right child must come later
+				if (node.offset <= i + 1 || node.offset >= header.nodeCount || pendingCount == maxDepth)
+				{
+					throw std::runtime_error("BVH::load(): Image is corrupt.");
+				}
+
+				pending[pendingCount++] = node.offset;
+			}
+		}
+	}
+
+	// Free any built hierarchy and point at the arrays in the image
+	nodes.clear();
+	nodes.shrink_to_fit();
+	packets.clear();
+	packets.shrink_to_fit();
+	indices.clear();
+	indices.shrink_to_fit();
+
+	triangleCount = header.triangleCount;
+	nodeData = reinterpret_cast<const Node*>(image + header.nodeOffset);
+	packetData = reinterpret_cast<const TrianglePacket<4>*>(image + header.packetOffset);
+	indexData = reinterpret_cast<const std::uint32_t*>(image + header.indexOffset);
+	nodeCount = header.nodeCount;
+	packetCount = header.packetCount;
+}
+
+void BVH::bindArrays()
+{
+	nodeData = nodes.data();
+	packetData = packets.data();
+	indexData = indices.data();
+	nodeCount = nodes.size();
+	packetCount = packets.size();
+}
+
+void BVH::subdivide(std::uint32_t begin, std::uint32_t end, std::size_t depth, const std::vector<Vector3>& triangleMin, const std::vector<Vector3>& triangleMax, const std::vector<Vector3>& centroids)
+{
+	std::uint32_t nodeIndex = static_cast<std::uint32_t>(nodes.size());
+	nodes.emplace_back();
+
+	// Calculate node bounds and centroid bounds
+	Vector3 boundsMin(std::numeric_limits<float>::infinity());
+	Vector3 boundsMax(-std::numeric_limits<float>::infinity());
+	Vector3 centroidMin = boundsMin;
+	Vector3 centroidMax = boundsMax;
+	for (std::uint32_t i = begin; i < end; ++i)
+	{
+		std::uint32_t index = indices[i];
+		boundsMin = glm::min(boundsMin, triangleMin[index]);
+		boundsMax = glm::max(boundsMax, triangleMax[index]);
+		centroidMin = glm::min(centroidMin, centroids[index]);
+		centroidMax = glm::max(centroidMax, centroids[index]);
+	}
+	nodes[nodeIndex].min = boundsMin;
+	nodes[nodeIndex].max = boundsMax;
+	nodes[nodeIndex].offset = begin;
+	nodes[nodeIndex].count = end - begin;
+
+	std::uint32_t count = end - begin;
+	if (count <= minLeafSize || depth >= maxDepth)
+	{
+		return;
+	}
+
+	// Find the cheapest split according to the binned surface area heuristic
+	float bestCost = std::numeric_limits<float>::infinity();
+	std::size_t bestAxis = 3;
+	std::size_t bestSplit = 0;
+	for (std::size_t axis = 0; axis < 3; ++axis)
+	{
+		float extent = centroidMax[axis] - centroidMin[axis];
+		if (extent <= 0.0f)
+		{
+			continue;
+		}
+
+		// Bin triangles by centroid
+		Vector3 binMin[binCount];
+		Vector3 binMax[binCount];
+		std::uint32_t binCounts[binCount] = {0};
+		for (std::size_t i = 0; i < binCount; ++i)
+		{
+			binMin[i] = Vector3(std::numeric_limits<float>::infinity());
+			binMax[i] = Vector3(-std::numeric_limits<float>::infinity());
+		}
+
+		float scale = static_cast<float>(binCount) / extent;
+		for (std::uint32_t i = begin; i < end; ++i)
+		{
+			std::uint32_t index = indices[i];
+			std::size_t bin = std::min(binCount - 1, static_cast<std::size_t>((centroids[index][axis] - centroidMin[axis]) * scale));
+			binMin[bin] = glm::min(binMin[bin], triangleMin[index]);
+			binMax[bin] = glm::max(binMax[bin], triangleMax[index]);
+			++binCounts[bin];
+		}
+
+		// Sweep from the right to accumulate the cost of each right partition
+		float rightCosts[binCount];
+		Vector3 sweepMin(std::numeric_limits<float>::infinity());
+		Vector3 sweepMax(-std::numeric_limits<float>::infinity());
+		std::uint32_t sweepCount = 0;
+		for (std::size_t i = binCount - 1; i > 0; --i)
+		{
+			sweepMin = glm::min(sweepMin, binMin[i]);
+			sweepMax = glm::max(sweepMax, binMax[i]);
+			sweepCount += binCounts[i];
+			rightCosts[i] = (sweepCount) ? halfSurfaceArea(sweepMin, sweepMax) * static_cast<float>(sweepCount) : 0.0f;
+		}
+
+		// Sweep from the left and evaluate each split
+		sweepMin = Vector3(std::numeric_limits<float>::infinity());
+		sweepMax = Vector3(-std::numeric_limits<float>::infinity());
+		sweepCount = 0;
+		for (std::size_t i = 1; i < binCount; ++i)
+		{
+			sweepMin = glm::min(sweepMin, binMin[i - 1]);
+			sweepMax = glm::max(sweepMax, binMax[i - 1]);
+			sweepCount += binCounts[i - 1];
+			if (!sweepCount || sweepCount == count)
+			{
+				continue;
+			}
+
+			float cost = halfSurfaceArea(sweepMin, sweepMax) * static_cast<float>(sweepCount) + rightCosts[i];
+			if (cost < bestCost)
+			{
+				bestCost = cost;
+				bestAxis = axis;
+				bestSplit = i;
+			}
+		}
+	}
+
+	// Create a leaf if the triangles can not be separated, or if splitting would not reduce the expected cost
+	float leafCost = halfSurfaceArea(boundsMin, boundsMax) * static_cast<float>(count);
+	if (bestAxis == 3 || (bestCost >= leafCost && count <= maxLeafSize))
+	{
+		return;
+	}
+
+	// Partition triangles about the split
+	float scale = static_cast<float>(binCount) / (centroidMax[bestAxis] - centroidMin[bestAxis]);
+	auto middle = std::partition(indices.begin() + begin, indices.begin() + end,
+		[&](std::uint32_t index)
+		{
+			std::size_t bin = std::min(binCount - 1, static_cast<std::size_t>((centroids[index][bestAxis] - centroidMin[bestAxis]) * scale));
+			return (bin < bestSplit);
+		});
+	std::uint32_t split = static_cast<std::uint32_t>(middle - indices.begin());
+
+	// Build children, the left child immediately follows this node
+	subdivide(begin, split, depth + 1, triangleMin, triangleMax, centroids);
+	nodes[nodeIndex].offset = static_cast<std::uint32_t>(nodes.size());
+	nodes[nodeIndex].count = 0;
+	subdivide(split, end, depth + 1, triangleMin, triangleMax, centroids);
+}
+
+std::tuple<bool, float, std::size_t> BVH::closestHit(const Ray& ray, float tmax) const
+{
+	bool intersection = false;
+	std::size_t index = triangleCount;
+
+	if (!nodeCount)
+	{
+		return std::make_tuple(false, std::numeric_limits<float>::infinity(), index);
+	}
+
+	const Vector3 inverseDirection = invertDirection(ray.direction);
+	std::uint32_t stack[stackCapacity];
+	std::size_t stackSize = 0;
+	stack[stackSize++] = 0;
+
+	while (stackSize)
+	{
+		const Node& node = nodeData[stack[--stackSize]];
+
+		float t;
+		if (!intersectSlab(node, ray.origin, inverseDirection, tmax, &t))
+		{
+			continue;
+		}
+
+		if (node.count)
+		{
+			// Test triangles in leaf
+			for (std::uint32_t i = node.offset; i < node.offset + (node.count + 3) / 4; ++i)
+			{
+				float t[4];
+				std::uint32_t mask = intersects(ray, packetData[i], tmax, t);
+				for (std::uint32_t j = 0; j < 4; ++j)
+				{
+					if ((mask >> j) & 1 && t[j] <= tmax)
+					{
+						intersection = true;
+						tmax = t[j];
+						index = indexData[i * 4 + j];
+					}
+				}
+			}
+		}
+		else if (stackSize + 2 <= stackCapacity)
+		{
+			// Push the farther child first so the nearer child is traversed first
+			std::uint32_t left = static_cast<std::uint32_t>(&node - nodeData) + 1;
+			std::uint32_t right = node.offset;
+
+			float tleft;
+			float tright;
+			bool hitLeft = intersectSlab(nodeData[left], ray.origin, inverseDirection, tmax, &tleft);
+			bool hitRight = intersectSlab(nodeData[right], ray.origin, inverseDirection, tmax, &tright);
+
+			if (hitLeft && hitRight)
+			{
+				if (tleft <= tright)
+				{
+					stack[stackSize++] = right;
+					stack[stackSize++] = left;
+				}
+				else
+				{
+					stack[stackSize++] = left;
+					stack[stackSize++] = right;
+				}
+			}
+			else if (hitLeft)
+			{
+				stack[stackSize++] = left;
+			}
+			else if (hitRight)
+			{
+				stack[stackSize++] = right;
+			}
+		}
+	}
+
+	if (!intersection)
+	{
+		return std::make_tuple(false, std::numeric_limits<float>::infinity(), index);
+	}
+
+	return std::make_tuple(true, tmax, index);
+}
+
+bool BVH::anyHit(const Ray& ray, float tmax) const
+{
+	if (!nodeCount)
+	{
+		return false;
+	}
+
+	const Vector3 inverseDirection = invertDirection(ray.direction);
+	std::uint32_t stack[stackCapacity];
+	std::size_t stackSize = 0;
+	stack[stackSize++] = 0;
+
+	while (stackSize)
+	{
+		std::uint32_t nodeIndex = stack[--stackSize];
+		const Node& node = nodeData[nodeIndex];
+
+		float t;
+		if (!intersectSlab(node, ray.origin, inverseDirection, tmax, &t))
+		{
+			continue;
+		}
+
+		if (node.count)
+		{
+			for (std::uint32_t i = node.offset; i < node.offset + (node.count + 3) / 4; ++i)
+			{
+				float t[4];
+				if (intersects(ray, packetData[i], tmax, t))
+				{
+					return true;
+				}
+			}
+		}
+		else if (stackSize + 2 <= stackCapacity)
+		{
+			stack[stackSize++] = node.offset;
+			stack[stackSize++] = nodeIndex + 1;
+		}
+	}
+
+	return false;
+}
+
+void BVH::allHits(const Ray& ray, float tmax, std::vector<std::tuple<float, std::size_t>>* hits) const
+{
+	if (!nodeCount)
+	{
+		return;
+	}
+
+	const Vector3 inverseDirection = invertDirection(ray.direction);
+	std::uint32_t stack[stackCapacity];
+	std::size_t stackSize = 0;
+	stack[stackSize++] = 0;
+
+	while (stackSize)
+	{
+		std::uint32_t nodeIndex = stack[--stackSize];
+		const Node& node = nodeData[nodeIndex];
+
+		float t;
+		if (!intersectSlab(node, ray.origin, inverseDirection, tmax, &t))
+		{
+			continue;
+		}
+
+		if (node.count)
+		{
+			for (std::uint32_t i = node.offset; i < node.offset + (node.count + 3) / 4; ++i)
+			{
+				float t[4];
+				std::uint32_t mask = intersects(ray, packetData[i], tmax, t);
+				for (std::uint32_t j = 0; j < 4; ++j)
+				{
+					if ((mask >> j) & 1)
+					{
+						hits->push_back(std::make_tuple(t[j], static_cast<std::size_t>(indexData[i * 4 + j])));
+					}
+				}
+			}
+		}
+		else if (stackSize + 2 <= stackCapacity)
+		{
+			stack[stackSize++] = node.offset;
+			stack[stackSize++] = nodeIndex + 1;
+		}
+	}
+}
+
+} // namespace Emergent
+
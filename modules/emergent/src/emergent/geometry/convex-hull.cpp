@@ -20,19 +20,21 @@
 #include <emergent/geometry/convex-hull.hpp>
 #include <emergent/geometry/sphere.hpp>
 #include <emergent/geometry/aabb.hpp>
+#include <emergent/geometry/obb.hpp>
+#include <cmath>
+#include <stdexcept>
 
 namespace Emergent
 {
 
 ConvexHull::ConvexHull(std::size_t planeCount):
+	planes{},
 	planeCount(planeCount)
 {
-	planes = new Plane[planeCount]();
-}
-
-ConvexHull::~ConvexHull()
-{
-	delete[] planes;
+	if (planeCount > maxPlaneCount)
+	{
+		throw std::runtime_error("ConvexHull::ConvexHull(): Plane count exceeds maximum.");
+	}
 }
 
 bool ConvexHull::intersects(const Sphere& sphere) const
@@ -72,6 +74,29 @@ bool ConvexHull::intersects(const AABB& aabb) const
 	return true;
 }
 
+bool ConvexHull::intersects(const OBB& obb) const
+{
+	const Matrix3& axes = obb.getAxes();
+	const Vector3& extents = obb.getExtents();
+	
+	for (std::size_t i = 0; i < planeCount; ++i)
+	{
+		const Vector3& normal = planes[i].getNormal();
+		
+		// Distance from the center to the vertex farthest along the plane normal
+		float radius = std::abs(glm::dot(normal, axes[0])) * extents.x
+			+ std::abs(glm::dot(normal, axes[1])) * extents.y
+			+ std::abs(glm::dot(normal, axes[2])) * extents.z;
+		
+		if (planes[i].distance(obb.getCenter()) < -radius)
+		{
+			return false;
+		}
+	}
+	
+	return true;
+}
+
 bool ConvexHull::contains(const Vector3& point) const
 {
 	for (std::size_t i = 0; i < planeCount; ++i)
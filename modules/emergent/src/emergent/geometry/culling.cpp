@@ -0,0 +1,188 @@
+/*
+ * Copyright (C) 2017-2019  Christopher J. Howard
+ *
+ * This file is part of Emergent.
+ *
+ * Emergent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Emergent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Emergent.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <emergent/geometry/culling.hpp>
+#include <emergent/geometry/convex-hull.hpp>
+#include <emergent/geometry/packet-lanes.hpp>
+#include <algorithm>
+
+namespace Emergent
+{
+
+void cullAABBs(const ConvexHull& hull, std::size_t count, const float* minX, const float* minY, const float* minZ, const float* maxX, const float* maxY, const float* maxZ, std::uint32_t* visibility)
+{
+	typedef WideLanes L;
+
+	std::fill(visibility, visibility + (count + 31) / 32, 0u);
+
+	// For each plane, select the box coordinate arrays which form the vertex farthest along the plane normal
+	struct PlaneArrays
+	{
+		const Plane* plane;
+		const float* x;
+		const float* y;
+		const float* z;
+	};
+
+	// Hulls never hold more than ConvexHull::maxPlaneCount planes, so the selection fits on the stack
+	std::size_t planeCount = hull.getPlaneCount();
+	PlaneArrays planes[ConvexHull::maxPlaneCount];
+	for (std::size_t i = 0; i < planeCount; ++i)
+	{
+		const Plane& plane = hull.getPlane(i);
+		const Vector3& normal = plane.getNormal();
+
+		planes[i].plane = &plane;
+		planes[i].x = (normal.x > 0.0f) ? maxX : minX;
+		planes[i].y = (normal.y > 0.0f) ? maxY : minY;
+		planes[i].z = (normal.z > 0.0f) ? maxZ : minZ;
+	}
+
+	// Test boxes several at a time
+	const L zero(0.0f);
+	std::size_t i = 0;
+	for (; i + L::width <= count; i += L::width)
+	{
+		std::uint32_t mask = (1u << L::width) - 1;
+		for (std::size_t j = 0; j < planeCount && mask; ++j)
+		{
+			const Vector3& normal = planes[j].plane->getNormal();
+
+			// Evaluate the plane distance in the same order as Plane::distance()
+			L distance = L(planes[j].plane->getDistance())
+				+ ((L(normal.x) * L::loadUnaligned(planes[j].x + i)
+				+ L(normal.y) * L::loadUnaligned(planes[j].y + i))
+				+ L(normal.z) * L::loadUnaligned(planes[j].z + i));
+
+			mask &= ~bits(lessThan(distance, zero));
+		}
+
+		visibility[i / 32] |= mask << (i % 32);
+	}
+
+	// Test remaining boxes individually
+	for (; i < count; ++i)
+	{
+		bool visible = true;
+		for (std::size_t j = 0; j < planeCount; ++j)
+		{
+			Vector3 pv(planes[j].x[i], planes[j].y[i], planes[j].z[i]);
+			if (planes[j].plane->distance(pv) < 0.0f)
+			{
+				visible = false;
+				break;
+			}
+		}
+
+		if (visible)
+		{
+			visibility[i / 32] |= 1u << (i % 32);
+		}
+	}
+}
+
+namespace
+{
+
+/// Component-wise minimum and maximum for the scalar remainder of a batch
+inline float min(float x, float y) { return (y < x) ? y : x; }
+inline float max(float x, float y) { return (y > x) ? y : x; }
+
+/**
+ * Transforms one component of a box, or of several boxes at once, using Arvo's method. The summation order matches that of AABB::transformed(const Matrix4&) const.
+ *
+ * @param row Row of the matrix which produces this component, as the three linear elements followed by the translation.
+ */
+template <class T>
+inline void transformComponent(const float* row, const T& minX, const T& minY, const T& minZ, const T& maxX, const T& maxY, const T& maxZ, T* resultMin, T* resultMax)
+{
+	T ax = T(row[0]) * minX;
+	T bx = T(row[0]) * maxX;
+	T ay = T(row[1]) * minY;
+	T by = T(row[1]) * maxY;
+	T az = T(row[2]) * minZ;
+	T bz = T(row[2]) * maxZ;
+	
+	*resultMin = ((T(row[3]) + min(ax, bx)) + min(ay, by)) + min(az, bz);
+	*resultMax = ((T(row[3]) + max(ax, bx)) + max(ay, by)) + max(az, bz);
+}
+
+} // namespace
+
+void transformAABBs(const Matrix4& matrix, std::size_t count, const float* minX, const float* minY, const float* minZ, const float* maxX, const float* maxY, const float* maxZ, float* resultMinX, float* resultMinY, float* resultMinZ, float* resultMaxX, float* resultMaxY, float* resultMaxZ)
+{
+	typedef WideLanes L;
+
+	// Gather the rows of the affine part of the column-major matrix
+	float rows[3][4];
+	for (int i = 0; i < 3; ++i)
+	{
+		for (int j = 0; j < 4; ++j)
+		{
+			rows[i][j] = matrix[j][i];
+		}
+	}
+
+	float* resultMins[3] = {resultMinX, resultMinY, resultMinZ};
+	float* resultMaxs[3] = {resultMaxX, resultMaxY, resultMaxZ};
+
+	// Transform boxes several at a time. All inputs are loaded before any results are stored, so the result arrays may alias the inputs.
+	std::size_t i = 0;
+	for (; i + L::width <= count; i += L::width)
+	{
+		L x0 = L::loadUnaligned(minX + i);
+		L y0 = L::loadUnaligned(minY + i);
+		L z0 = L::loadUnaligned(minZ + i);
+		L x1 = L::loadUnaligned(maxX + i);
+		L y1 = L::loadUnaligned(maxY + i);
+		L z1 = L::loadUnaligned(maxZ + i);
+
+		L resultMin[3];
+		L resultMax[3];
+		for (int j = 0; j < 3; ++j)
+		{
+			transformComponent(rows[j], x0, y0, z0, x1, y1, z1, &resultMin[j], &resultMax[j]);
+		}
+
+		for (int j = 0; j < 3; ++j)
+		{
+			resultMin[j].store(resultMins[j] + i);
+			resultMax[j].store(resultMaxs[j] + i);
+		}
+	}
+
+	// Transform remaining boxes individually
+	for (; i < count; ++i)
+	{
+		float x0 = minX[i];
+		float y0 = minY[i];
+		float z0 = minZ[i];
+		float x1 = maxX[i];
+		float y1 = maxY[i];
+		float z1 = maxZ[i];
+
+		for (int j = 0; j < 3; ++j)
+		{
+			transformComponent(rows[j], x0, y0, z0, x1, y1, z1, resultMins[j] + i, resultMaxs[j] + i);
+		}
+	}
+}
+
+} // namespace Emergent
+
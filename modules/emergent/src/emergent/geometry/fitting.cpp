@@ -0,0 +1,291 @@
+/*
+ * Copyright (C) 2017-2019  Christopher J. Howard
+ *
+ * This file is part of Emergent.
+ *
+ * Emergent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Emergent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Emergent.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <emergent/geometry/fitting.hpp>
+#include <emergent/geometry/aabb.hpp>
+#include <emergent/geometry/triangle-mesh.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace Emergent
+{
+
+namespace
+{
+
+typedef glm::dvec3 DVector3;
+
+/// Sphere in double precision, for the intermediate results of Welzl's algorithm.
+struct DSphere
+{
+	DVector3 center;
+	double radius;
+	
+	bool contains(const DVector3& point) const
+	{
+		// Allow for rounding error in the circumscribed spheres
+		return glm::length(point - center) <= radius + 1e-9 * std::max(1.0, radius);
+	}
+};
+
+DSphere circumscribe(const DVector3& a)
+{
+	return {a, 0.0};
+}
+
+DSphere circumscribe(const DVector3& a, const DVector3& b)
+{
+	return {(a + b) * 0.5, glm::length(b - a) * 0.5};
+}
+
+DSphere circumscribe(const DVector3& a, const DVector3& b, const DVector3& c)
+{
+	DVector3 ab = b - a;
+	DVector3 ac = c - a;
+	DVector3 normal = glm::cross(ab, ac);
+	double denominator = 2.0 * glm::dot(normal, normal);
+	
+	// Collinear points are bounded by the sphere of the farthest pair
+	if (denominator <= 1e-12 * glm::dot(ab, ab) * glm::dot(ac, ac))
+	{
+		DSphere spheres[3] = {circumscribe(a, b), circumscribe(a, c), circumscribe(b, c)};
+		return *std::max_element(spheres, spheres + 3, [](const DSphere& x, const DSphere& y) { return x.radius < y.radius; });
+	}
+	
+	DVector3 offset = (glm::cross(normal, ab) * glm::dot(ac, ac) + glm::cross(ac, normal) * glm::dot(ab, ab)) / denominator;
+	return {a + offset, glm::length(offset)};
+}
+
+DSphere circumscribe(const DVector3& a, const DVector3& b, const DVector3& c, const DVector3& d)
+{
+	DVector3 ab = b - a;
+	DVector3 ac = c - a;
+	DVector3 ad = d - a;
+	double denominator = 2.0 * glm::dot(ab, glm::cross(ac, ad));
+	
+	// Coplanar points are bounded by the smallest sphere through three of them which contains the fourth
+	double scale = glm::length(ab) * glm::length(ac) * glm::length(ad);
+	if (std::abs(denominator) <= 1e-12 * scale)
+	{
+		DSphere spheres[4] = {circumscribe(a, b, c), circumscribe(a, b, d), circumscribe(a, c, d), circumscribe(b, c, d)};
+		const DVector3* excluded[4] = {&d, &c, &b, &a};
+		
+		DSphere result = {a, std::numeric_limits<double>::infinity()};
+		for (std::size_t i = 0; i < 4; ++i)
+		{
+			if (spheres[i].radius < result.radius && spheres[i].contains(*excluded[i]))
+			{
+				result = spheres[i];
+			}
+		}
+		
+		return result;
+	}
+	
+	DVector3 offset = (glm::cross(ac, ad) * glm::dot(ab, ab) + glm::cross(ad, ab) * glm::dot(ac, ac) + glm::cross(ab, ac) * glm::dot(ad, ad)) / denominator;
+	return {a + offset, glm::length(offset)};
+}
+
+/**
+ * Finds the eigenvectors of a symmetric matrix with the cyclic Jacobi method.
+ *
+ * @param matrix Symmetric matrix, which is diagonalized in place.
+ * @return Matrix whose columns are the eigenvectors.
+ */
+glm::dmat3 diagonalize(glm::dmat3* matrix)
+{
+	glm::dmat3& a = *matrix;
+	glm::dmat3 v(1.0);
+	
+	for (int sweep = 0; sweep < 32; ++sweep)
+	{
+		double off = a[1][0] * a[1][0] + a[2][0] * a[2][0] + a[2][1] * a[2][1];
+		if (off <= 1e-24 * (a[0][0] * a[0][0] + a[1][1] * a[1][1] + a[2][2] * a[2][2]))
+		{
+			break;
+		}
+		
+		for (int p = 0; p < 2; ++p)
+		{
+			for (int q = p + 1; q < 3; ++q)
+			{
+				if (a[q][p] == 0.0)
+				{
+					continue;
+				}
+				
+				// Rotate in the pq-plane to zero the element a[q][p]
+				double theta = (a[q][q] - a[p][p]) / (2.0 * a[q][p]);
+				double t = ((theta >= 0.0) ? 1.0 : -1.0) / (std::abs(theta) + std::sqrt(theta * theta + 1.0));
+				double c = 1.0 / std::sqrt(t * t + 1.0);
+				double s = t * c;
+				
+				glm::dmat3 rotation(1.0);
+				rotation[p][p] = c;
+				rotation[q][q] = c;
+				rotation[q][p] = s;
+				rotation[p][q] = -s;
+				
+				a = glm::transpose(rotation) * a * rotation;
+				v = v * rotation;
+			}
+		}
+	}
+	
+	return v;
+}
+
+std::vector<Vector3> getPositions(const TriangleMesh& mesh)
+{
+	const std::vector<TriangleMesh::Vertex>* vertices = mesh.getVertices();
+	
+	std::vector<Vector3> positions;
+	positions.reserve(vertices->size());
+	for (const TriangleMesh::Vertex& vertex: *vertices)
+	{
+		positions.push_back(vertex.position);
+	}
+	
+	return positions;
+}
+
+} // namespace
+
+Sphere fitSphere(std::size_t count, const Vector3* points)
+{
+	if (!count)
+	{
+		return Sphere(Vector3(0.0f), 0.0f);
+	}
+	
+	// Shuffle the points, which makes the expected running time linear
+	std::vector<DVector3> p(points, points + count);
+	std::shuffle(p.begin(), p.end(), std::minstd_rand());
+	
+	// Iterative form of Welzl's algorithm, where each nested loop fixes one more point on the boundary of the sphere
+	DSphere sphere = circumscribe(p[0]);
+	for (std::size_t i = 1; i < count; ++i)
+	{
+		if (sphere.contains(p[i]))
+			continue;
+		
+		sphere = circumscribe(p[i]);
+		for (std::size_t j = 0; j < i; ++j)
+		{
+			if (sphere.contains(p[j]))
+				continue;
+			
+			sphere = circumscribe(p[i], p[j]);
+			for (std::size_t k = 0; k < j; ++k)
+			{
+				if (sphere.contains(p[k]))
+					continue;
+				
+				sphere = circumscribe(p[i], p[j], p[k]);
+				for (std::size_t l = 0; l < k; ++l)
+				{
+					if (sphere.contains(p[l]))
+						continue;
+					
+					sphere = circumscribe(p[i], p[j], p[k], p[l]);
+				}
+			}
+		}
+	}
+	
+	// Grow the sphere to contain all points despite rounding to single precision
+	Vector3 center(sphere.center);
+	float radius = 0.0f;
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		radius = std::max(radius, glm::length(points[i] - center));
+	}
+	
+	return Sphere(center, radius);
+}
+
+Sphere fitSphere(const TriangleMesh& mesh)
+{
+	std::vector<Vector3> positions = getPositions(mesh);
+	return fitSphere(positions.size(), positions.data());
+}
+
+OBB fitOBB(std::size_t count, const Vector3* points)
+{
+	if (!count)
+	{
+		return OBB(Vector3(0.0f), Matrix3(1.0f), Vector3(0.0f));
+	}
+	
+	// Calculate the covariance matrix of the points
+	DVector3 mean(0.0);
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		mean += DVector3(points[i]);
+	}
+	mean /= static_cast<double>(count);
+	
+	glm::dmat3 covariance(0.0);
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		DVector3 d = DVector3(points[i]) - mean;
+		covariance += glm::outerProduct(d, d);
+	}
+	covariance /= static_cast<double>(count);
+	
+	// Use the eigenvectors of the covariance matrix as the box axes
+	glm::dmat3 eigenvectors = diagonalize(&covariance);
+	Matrix3 axes;
+	axes[0] = glm::normalize(Vector3(eigenvectors[0]));
+	axes[1] = glm::normalize(Vector3(eigenvectors[1]) - axes[0] * glm::dot(axes[0], Vector3(eigenvectors[1])));
+	axes[2] = glm::cross(axes[0], axes[1]);
+	
+	// Project the points onto each axis
+	AABB local(points[0] * axes, points[0] * axes);
+	AABB aabb(points[0], points[0]);
+	for (std::size_t i = 1; i < count; ++i)
+	{
+		local.add(points[i] * axes);
+		aabb.add(points[i]);
+	}
+	
+	Vector3 extents = (local.getMax() - local.getMin()) * 0.5f;
+	Vector3 aabbExtents = (aabb.getMax() - aabb.getMin()) * 0.5f;
+	if (aabbExtents.x * aabbExtents.y * aabbExtents.z <= extents.x * extents.y * extents.z)
+	{
+		return OBB(aabb);
+	}
+	
+	Vector3 center = axes * ((local.getMin() + local.getMax()) * 0.5f);
+	return OBB(center, axes, extents);
+}
+
+OBB fitOBB(const TriangleMesh& mesh)
+{
+	std::vector<Vector3> positions = getPositions(mesh);
+	return fitOBB(positions.size(), positions.data());
+}
+
+} // namespace Emergent
+
@@ -0,0 +1,166 @@
+/*
+ * Copyright (C) 2017-2019  Christopher J. Howard
+ *
+ * This file is part of Emergent.
+ *
+ * Emergent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Emergent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Emergent.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <emergent/geometry/obb.hpp>
+#include <emergent/geometry/aabb.hpp>
+#include <emergent/geometry/sphere.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace Emergent
+{
+
+OBB::OBB(const AABB& aabb):
+	center((aabb.getMin() + aabb.getMax()) * 0.5f),
+	axes(1.0f),
+	extents((aabb.getMax() - aabb.getMin()) * 0.5f)
+{}
+
+AABB OBB::getBounds() const
+{
+	Vector3 radius = glm::abs(axes[0]) * extents.x + glm::abs(axes[1]) * extents.y + glm::abs(axes[2]) * extents.z;
+	return AABB(center - radius, center + radius);
+}
+
+OBB OBB::transformed(const Transform& transform) const
+{
+	Matrix3 m = glm::mat3_cast(transform.rotation);
+	m[0] *= transform.scale.x;
+	m[1] *= transform.scale.y;
+	m[2] *= transform.scale.z;
+	
+	// Transformed edge directions, which are orthogonal unless the scale is non-uniform
+	Vector3 directions[3] = {m * axes[0], m * axes[1], m * axes[2]};
+	
+	Matrix3 transformedAxes;
+	transformedAxes[0] = glm::normalize(directions[0]);
+	transformedAxes[1] = glm::normalize(directions[1] - transformedAxes[0] * glm::dot(transformedAxes[0], directions[1]));
+	transformedAxes[2] = glm::cross(transformedAxes[0], transformedAxes[1]);
+	
+	Vector3 transformedExtents;
+	for (int i = 0; i < 3; ++i)
+	{
+		transformedExtents[i] = std::abs(glm::dot(transformedAxes[i], directions[0])) * extents.x
+			+ std::abs(glm::dot(transformedAxes[i], directions[1])) * extents.y
+			+ std::abs(glm::dot(transformedAxes[i], directions[2])) * extents.z;
+	}
+	
+	return OBB(transform.transform(center), transformedAxes, transformedExtents);
+}
+
+bool OBB::intersects(const Sphere& sphere) const
+{
+	// Find the point in the box closest to the sphere center
+	Vector3 local = (sphere.getCenter() - center) * axes;
+	Vector3 closest = glm::clamp(local, -extents, extents);
+	Vector3 d = local - closest;
+	
+	return (glm::dot(d, d) <= sphere.getRadius() * sphere.getRadius());
+}
+
+bool OBB::intersects(const AABB& aabb) const
+{
+	return intersects(OBB(aabb));
+}
+
+bool OBB::intersects(const OBB& obb) const
+{
+	// Separating axis test, with the other box expressed in the frame of this box
+	Matrix3 r = glm::transpose(axes) * obb.axes;
+	Vector3 t = (obb.center - center) * axes;
+	
+	// Guard against near-zero cross products of nearly parallel edges
+	const float epsilon = 1e-6f;
+	Matrix3 absR;
+	for (int i = 0; i < 3; ++i)
+	{
+		absR[i] = glm::abs(r[i]) + epsilon;
+	}
+	
+	// Axes of this box
+	for (int i = 0; i < 3; ++i)
+	{
+		float ra = extents[i];
+		float rb = obb.extents[0] * absR[0][i] + obb.extents[1] * absR[1][i] + obb.extents[2] * absR[2][i];
+		if (std::abs(t[i]) > ra + rb)
+			return false;
+	}
+	
+	// Axes of the other box
+	for (int i = 0; i < 3; ++i)
+	{
+		float ra = glm::dot(extents, absR[i]);
+		float rb = obb.extents[i];
+		if (std::abs(glm::dot(t, r[i])) > ra + rb)
+			return false;
+	}
+	
+	// Cross products of the axes of both boxes
+	for (int i = 0; i < 3; ++i)
+	{
+		int i1 = (i + 1) % 3;
+		int i2 = (i + 2) % 3;
+		
+		for (int j = 0; j < 3; ++j)
+		{
+			int j1 = (j + 1) % 3;
+			int j2 = (j + 2) % 3;
+			
+			float ra = extents[i1] * absR[j][i2] + extents[i2] * absR[j][i1];
+			float rb = obb.extents[j1] * absR[j2][i] + obb.extents[j2] * absR[j1][i];
+			if (std::abs(t[i2] * r[j][i1] - t[i1] * r[j][i2]) > ra + rb)
+				return false;
+		}
+	}
+	
+	return true;
+}
+
+bool OBB::contains(const Vector3& point) const
+{
+	Vector3 local = glm::abs((point - center) * axes);
+	return (local.x <= extents.x && local.y <= extents.y && local.z <= extents.z);
+}
+
+bool OBB::contains(const Sphere& sphere) const
+{
+	Vector3 local = glm::abs((sphere.getCenter() - center) * axes) + sphere.getRadius();
+	return (local.x <= extents.x && local.y <= extents.y && local.z <= extents.z);
+}
+
+bool OBB::contains(const AABB& aabb) const
+{
+	Vector3 aabbCenter = (aabb.getMin() + aabb.getMax()) * 0.5f;
+	Vector3 aabbExtents = (aabb.getMax() - aabb.getMin()) * 0.5f;
+	
+	// Project the box onto each axis
+	for (int i = 0; i < 3; ++i)
+	{
+		float distance = std::abs(glm::dot(axes[i], aabbCenter - center)) + glm::dot(glm::abs(axes[i]), aabbExtents);
+		if (distance > extents[i])
+			return false;
+	}
+	
+	return true;
+}
+
+} // namespace Emergent
+
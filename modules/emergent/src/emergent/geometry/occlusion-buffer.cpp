@@ -0,0 +1,360 @@
+/*
+ * Copyright (C) 2017-2019  Christopher J. Howard
+ *
+ * This file is part of Emergent.
+ *
+ * Emergent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Emergent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Emergent.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <emergent/geometry/occlusion-buffer.hpp>
+#include <emergent/geometry/triangle-mesh.hpp>
+#include <emergent/geometry/packet-lanes.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Emergent
+{
+
+namespace
+{
+
+/// Offsets of the pixels in each lane from the first pixel of a packet
+alignas(32) const float laneOffsets[8] = {0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f};
+
+} // namespace
+
+OcclusionBuffer::OcclusionBuffer():
+	OcclusionBuffer(0, 0)
+{}
+
+OcclusionBuffer::OcclusionBuffer(int width, int height):
+	viewProjection(1.0f)
+{
+	resize(width, height);
+}
+
+void OcclusionBuffer::resize(int width, int height)
+{
+	this->width = std::max(width, 0);
+	this->height = std::max(height, 0);
+	tileColumns = (this->width + tileWidth - 1) / tileWidth;
+	tileRows = (this->height + tileHeight - 1) / tileHeight;
+
+	depths.resize(static_cast<std::size_t>(tileColumns) * tileRows * tileWidth * tileHeight);
+	tileDepths.resize(static_cast<std::size_t>(tileColumns) * tileRows);
+
+	clear(viewProjection);
+}
+
+void OcclusionBuffer::clear(const Matrix4& viewProjection)
+{
+	this->viewProjection = viewProjection;
+
+	std::fill(depths.begin(), depths.end(), std::numeric_limits<float>::infinity());
+	std::fill(tileDepths.begin(), tileDepths.end(), std::numeric_limits<float>::infinity());
+
+	// Pixels which pad the edge tiles are set to the nearest depth, so they never raise the farthest depth of their tiles
+	for (int y = 0; y < tileRows * tileHeight; ++y)
+	{
+		for (int x = (y < height) ? width : 0; x < tileColumns * tileWidth; ++x)
+		{
+			depths[getTileOffset(x / tileWidth, y / tileHeight) + (y % tileHeight) * tileWidth + x % tileWidth] = 0.0f;
+		}
+	}
+}
+
+void OcclusionBuffer::rasterize(const Matrix4& transform, std::size_t vertexCount, const Vector3* positions, std::size_t triangleCount, const std::uint32_t* indices)
+{
+	screenVertices.resize(vertexCount);
+	Matrix4 matrix = viewProjection * transform;
+	for (std::size_t i = 0; i < vertexCount; ++i)
+	{
+		screenVertices[i] = project(matrix, positions[i]);
+	}
+
+	for (std::size_t i = 0; i < triangleCount; ++i)
+	{
+		const std::uint32_t* triangle = indices + i * 3;
+		rasterize(screenVertices[triangle[0]], screenVertices[triangle[1]], screenVertices[triangle[2]]);
+	}
+}
+
+void OcclusionBuffer::rasterize(const Matrix4& transform, const TriangleMesh& mesh)
+{
+	const std::vector<TriangleMesh::Vertex>* vertices = mesh.getVertices();
+	const std::vector<TriangleMesh::Edge>* edges = mesh.getEdges();
+
+	screenVertices.resize(vertices->size());
+	Matrix4 matrix = viewProjection * transform;
+	for (std::size_t i = 0; i < vertices->size(); ++i)
+	{
+		screenVertices[i] = project(matrix, (*vertices)[i].position);
+	}
+
+	std::size_t triangleCount = mesh.getTriangles()->size();
+	for (std::size_t i = 0; i < triangleCount; ++i)
+	{
+		std::uint32_t edge = TriangleMesh::getEdge(static_cast<std::uint32_t>(i));
+		rasterize(screenVertices[(*edges)[edge].vertex], screenVertices[(*edges)[edge + 1].vertex], screenVertices[(*edges)[edge + 2].vertex]);
+	}
+}
+
+bool OcclusionBuffer::isVisible(const AABB& bounds) const
+{
+	typedef WideLanes L;
+
+	const Vector3& minPoint = bounds.getMin();
+	const Vector3& maxPoint = bounds.getMax();
+
+	// Find the screen-space rectangle and nearest depth of the box
+	float minX = std::numeric_limits<float>::infinity();
+	float minY = minX;
+	float maxX = -minX;
+	float maxY = -minX;
+	float minDepth = minX;
+	for (int i = 0; i < 8; ++i)
+	{
+		Vector4 corner((i & 1) ? maxPoint.x : minPoint.x, (i & 2) ? maxPoint.y : minPoint.y, (i & 4) ? maxPoint.z : minPoint.z, 1.0f);
+		Vector4 clip = viewProjection * corner;
+		if (clip.w <= 0.0f || clip.z < -clip.w)
+		{
+			return true;
+		}
+
+		float x = clip.x / clip.w;
+		float y = clip.y / clip.w;
+		minX = std::min(minX, x);
+		minY = std::min(minY, y);
+		maxX = std::max(maxX, x);
+		maxY = std::max(maxY, y);
+		minDepth = std::min(minDepth, clip.z / clip.w);
+	}
+	minDepth = minDepth * 0.5f + 0.5f;
+
+	// Find the pixels which the rectangle touches, dilated by one pixel to cover the silhouette error of occluders
+	float fx0 = std::max(std::floor((minX * 0.5f + 0.5f) * static_cast<float>(width)) - 1.0f, 0.0f);
+	float fy0 = std::max(std::floor((minY * 0.5f + 0.5f) * static_cast<float>(height)) - 1.0f, 0.0f);
+	float fx1 = std::min(std::floor((maxX * 0.5f + 0.5f) * static_cast<float>(width)) + 1.0f, static_cast<float>(width - 1));
+	float fy1 = std::min(std::floor((maxY * 0.5f + 0.5f) * static_cast<float>(height)) + 1.0f, static_cast<float>(height - 1));
+	if (!(fx0 <= fx1 && fy0 <= fy1))
+	{
+		return true;
+	}
+
+	int x0 = static_cast<int>(fx0);
+	int y0 = static_cast<int>(fy0);
+	int x1 = static_cast<int>(fx1);
+	int y1 = static_cast<int>(fy1);
+
+	// The box is visible if any pixel in the rectangle is no nearer than the box
+	const L nearest(minDepth);
+	for (int tileY = y0 / tileHeight; tileY <= y1 / tileHeight; ++tileY)
+	{
+		for (int tileX = x0 / tileWidth; tileX <= x1 / tileWidth; ++tileX)
+		{
+			// Skip tiles which are entirely nearer than the box
+			std::size_t tile = static_cast<std::size_t>(tileY) * tileColumns + tileX;
+			if (tileDepths[tile] < minDepth)
+			{
+				continue;
+			}
+
+			const float* pixels = depths.data() + tile * (tileWidth * tileHeight);
+			int rowBegin = std::max(y0 - tileY * tileHeight, 0);
+			int rowEnd = std::min(y1 - tileY * tileHeight, tileHeight - 1);
+			for (int row = rowBegin; row <= rowEnd; ++row)
+			{
+				for (int column = 0; column < tileWidth; column += static_cast<int>(L::width))
+				{
+					// Mask the lanes of pixels inside the rectangle
+					int x = tileX * tileWidth + column;
+					int laneBegin = std::max(x0 - x, 0);
+					int laneEnd = std::min(x1 - x, static_cast<int>(L::width) - 1);
+					if (laneBegin > laneEnd)
+					{
+						continue;
+					}
+					std::uint32_t lanes = ((2u << laneEnd) - 1) & ~((1u << laneBegin) - 1);
+
+					L depth = L::loadUnaligned(pixels + row * tileWidth + column);
+					if (bits(lessThanEqual(nearest, depth)) & lanes)
+					{
+						return true;
+					}
+				}
+			}
+		}
+	}
+
+	return false;
+}
+
+float OcclusionBuffer::getDepth(int x, int y) const
+{
+	return depths[getTileOffset(x / tileWidth, y / tileHeight) + (y % tileHeight) * tileWidth + x % tileWidth];
+}
+
+OcclusionBuffer::ScreenVertex OcclusionBuffer::project(const Matrix4& matrix, const Vector3& position) const
+{
+	Vector4 clip = matrix * Vector4(position, 1.0f);
+
+	ScreenVertex vertex;
+	vertex.x = (clip.x / clip.w * 0.5f + 0.5f) * static_cast<float>(width);
+	vertex.y = (clip.y / clip.w * 0.5f + 0.5f) * static_cast<float>(height);
+	vertex.depth = clip.z / clip.w * 0.5f + 0.5f;
+	vertex.clipped = (clip.w <= 0.0f || clip.z < -clip.w);
+
+	return vertex;
+}
+
+void OcclusionBuffer::rasterize(const ScreenVertex& v0, const ScreenVertex& v1, const ScreenVertex& v2)
+{
+	typedef WideLanes L;
+
+	if (v0.clipped || v1.clipped || v2.clipped)
+	{
+		return;
+	}
+
+	// Order the vertices counterclockwise, and reject degenerate triangles
+	const ScreenVertex* vertices[3] = {&v0, &v1, &v2};
+	float area = (v1.x - v0.x) * (v2.y - v0.y) - (v2.x - v0.x) * (v1.y - v0.y);
+	if (!(area > 0.0f))
+	{
+		if (!(area < 0.0f))
+		{
+			return;
+		}
+
+		std::swap(vertices[1], vertices[2]);
+		area = -area;
+	}
+
+	// Find the pixel centers inside the triangle's bounding rectangle
+	float minX = std::min(std::min(v0.x, v1.x), v2.x);
+	float minY = std::min(std::min(v0.y, v1.y), v2.y);
+	float maxX = std::max(std::max(v0.x, v1.x), v2.x);
+	float maxY = std::max(std::max(v0.y, v1.y), v2.y);
+	float fx0 = std::max(std::ceil(minX - 0.5f), 0.0f);
+	float fy0 = std::max(std::ceil(minY - 0.5f), 0.0f);
+	float fx1 = std::min(std::floor(maxX - 0.5f), static_cast<float>(width - 1));
+	float fy1 = std::min(std::floor(maxY - 0.5f), static_cast<float>(height - 1));
+	if (!(fx0 <= fx1 && fy0 <= fy1))
+	{
+		return;
+	}
+
+	int x0 = static_cast<int>(fx0);
+	int y0 = static_cast<int>(fy0);
+	int x1 = static_cast<int>(fx1);
+	int y1 = static_cast<int>(fy1);
+
+	// Set up an edge function `a * x + b * y + c` for the edge opposite each vertex, which is positive inside the triangle and equals the area at that vertex
+	float a[3];
+	float b[3];
+	float c[3];
+	for (int i = 0; i < 3; ++i)
+	{
+		const ScreenVertex& start = *vertices[(i + 1) % 3];
+		const ScreenVertex& end = *vertices[(i + 2) % 3];
+		a[i] = start.y - end.y;
+		b[i] = end.x - start.x;
+		c[i] = start.x * end.y - start.y * end.x;
+	}
+
+	// Interpolate depth with the normalized edge functions, offset to the farthest depth of the plane over each pixel
+	float dzdx = 0.0f;
+	float dzdy = 0.0f;
+	float dz = 0.0f;
+	for (int i = 0; i < 3; ++i)
+	{
+		dzdx += a[i] * vertices[i]->depth;
+		dzdy += b[i] * vertices[i]->depth;
+		dz += c[i] * vertices[i]->depth;
+	}
+	dzdx /= area;
+	dzdy /= area;
+	dz = dz / area + 0.5f * (std::abs(dzdx) + std::abs(dzdy));
+
+	float minDepth = std::min(std::min(v0.depth, v1.depth), v2.depth);
+	float maxDepth = std::max(std::max(v0.depth, v1.depth), v2.depth);
+
+	const L offsets = L::load(laneOffsets);
+	const L zero(0.0f);
+	const L farthest(maxDepth);
+	for (int tileY = y0 / tileHeight; tileY <= y1 / tileHeight; ++tileY)
+	{
+		for (int tileX = x0 / tileWidth; tileX <= x1 / tileWidth; ++tileX)
+		{
+			// Skip tiles in which every pixel is already nearer than the triangle
+			std::size_t tile = static_cast<std::size_t>(tileY) * tileColumns + tileX;
+			if (minDepth >= tileDepths[tile])
+			{
+				continue;
+			}
+
+			float* pixels = depths.data() + tile * (tileWidth * tileHeight);
+			bool written = false;
+			for (int row = 0; row < tileHeight; ++row)
+			{
+				float y = static_cast<float>(tileY * tileHeight + row) + 0.5f;
+				for (int column = 0; column < tileWidth; column += static_cast<int>(L::width))
+				{
+					float x = static_cast<float>(tileX * tileWidth + column) + 0.5f;
+
+					L e0 = L(a[0] * x + b[0] * y + c[0]) + L(a[0]) * offsets;
+					L e1 = L(a[1] * x + b[1] * y + c[1]) + L(a[1]) * offsets;
+					L e2 = L(a[2] * x + b[2] * y + c[2]) + L(a[2]) * offsets;
+					auto inside = lessThanEqual(zero, min(min(e0, e1), e2));
+					if (!bits(inside))
+					{
+						continue;
+					}
+
+					float* packet = pixels + row * tileWidth + column;
+					L depth = min(L(dz + dzdx * x + dzdy * y) + L(dzdx) * offsets, farthest);
+					L current = L::loadUnaligned(packet);
+					select(inside, min(current, depth), current).store(packet);
+					written = true;
+				}
+			}
+
+			if (written)
+			{
+				updateTileDepth(tile);
+			}
+		}
+	}
+}
+
+void OcclusionBuffer::updateTileDepth(std::size_t tile)
+{
+	typedef WideLanes L;
+
+	const float* pixels = depths.data() + tile * (tileWidth * tileHeight);
+	L farthest = L::loadUnaligned(pixels);
+	for (std::size_t i = L::width; i < tileWidth * tileHeight; i += L::width)
+	{
+		farthest = max(farthest, L::loadUnaligned(pixels + i));
+	}
+
+	float lanes[L::width];
+	farthest.store(lanes);
+	tileDepths[tile] = *std::max_element(lanes, lanes + L::width);
+}
+
+} // namespace Emergent
+
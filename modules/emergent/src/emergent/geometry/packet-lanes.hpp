@@ -0,0 +1,316 @@
+/*
+ * Copyright (C) 2017-2019  Christopher J. Howard
+ *
+ * This file is part of Emergent.
+ *
+ * Emergent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Emergent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Emergent.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EMERGENT_GEOMETRY_PACKET_LANES_HPP
+#define EMERGENT_GEOMETRY_PACKET_LANES_HPP
+
+#include <cstdint>
+#include <cstdlib>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define EMERGENT_PACKET_LANES_SSE
+	#include <emmintrin.h>
+#endif
+
+#if defined(__AVX__)
+	#define EMERGENT_PACKET_LANES_AVX
+	#include <immintrin.h>
+#endif
+
+/*
+ * Lane types used by the packet and batch kernels in the geometry module. Each lane type provides
+ * arithmetic, min/max, and comparisons that produce a mask convertible to a bit mask with `bits()`
+ * or usable to choose between lanes with `select()`.
+ * Lanes4 and Lanes8 hold four and eight floats, respectively. WideLanes is the widest lane type
+ * supported by the target instruction set.
+ */
+
+namespace Emergent
+{
+
+/**
+ * Portable fallback for packet lanes, used when no suitable instruction set is available.
+ */
+template <std::size_t N>
+struct ScalarLanes
+{
+	typedef std::uint32_t Mask;
+
+	static constexpr std::size_t width = N;
+
+	ScalarLanes() = default;
+
+	explicit ScalarLanes(float x)
+	{
+		for (std::size_t i = 0; i < N; ++i)
+			v[i] = x;
+	}
+
+	static ScalarLanes load(const float* x)
+	{
+		ScalarLanes result;
+		for (std::size_t i = 0; i < N; ++i)
+			result.v[i] = x[i];
+		return result;
+	}
+
+	static ScalarLanes loadUnaligned(const float* x)
+	{
+		return load(x);
+	}
+
+	void store(float* x) const
+	{
+		for (std::size_t i = 0; i < N; ++i)
+			x[i] = v[i];
+	}
+
+	float v[N];
+};
+
+template <std::size_t N>
+inline ScalarLanes<N> operator+(const ScalarLanes<N>& x, const ScalarLanes<N>& y)
+{
+	ScalarLanes<N> result;
+	for (std::size_t i = 0; i < N; ++i)
+		result.v[i] = x.v[i] + y.v[i];
+	return result;
+}
+
+template <std::size_t N>
+inline ScalarLanes<N> operator-(const ScalarLanes<N>& x, const ScalarLanes<N>& y)
+{
+	ScalarLanes<N> result;
+	for (std::size_t i = 0; i < N; ++i)
+		result.v[i] = x.v[i] - y.v[i];
+	return result;
+}
+
+template <std::size_t N>
+inline ScalarLanes<N> operator*(const ScalarLanes<N>& x, const ScalarLanes<N>& y)
+{
+	ScalarLanes<N> result;
+	for (std::size_t i = 0; i < N; ++i)
+		result.v[i] = x.v[i] * y.v[i];
+	return result;
+}
+
+template <std::size_t N>
+inline ScalarLanes<N> operator/(const ScalarLanes<N>& x, const ScalarLanes<N>& y)
+{
+	ScalarLanes<N> result;
+	for (std::size_t i = 0; i < N; ++i)
+		result.v[i] = x.v[i] / y.v[i];
+	return result;
+}
+
+template <std::size_t N>
+inline ScalarLanes<N> min(const ScalarLanes<N>& x, const ScalarLanes<N>& y)
+{
+	ScalarLanes<N> result;
+	for (std::size_t i = 0; i < N; ++i)
+		result.v[i] = (x.v[i] < y.v[i]) ? x.v[i] : y.v[i];
+	return result;
+}
+
+template <std::size_t N>
+inline ScalarLanes<N> max(const ScalarLanes<N>& x, const ScalarLanes<N>& y)
+{
+	ScalarLanes<N> result;
+	for (std::size_t i = 0; i < N; ++i)
+		result.v[i] = (x.v[i] > y.v[i]) ? x.v[i] : y.v[i];
+	return result;
+}
+
+template <std::size_t N>
+inline std::uint32_t lessThan(const ScalarLanes<N>& x, const ScalarLanes<N>& y)
+{
+	std::uint32_t mask = 0;
+	for (std::size_t i = 0; i < N; ++i)
+		mask |= static_cast<std::uint32_t>(x.v[i] < y.v[i]) << i;
+	return mask;
+}
+
+template <std::size_t N>
+inline std::uint32_t lessThanEqual(const ScalarLanes<N>& x, const ScalarLanes<N>& y)
+{
+	std::uint32_t mask = 0;
+	for (std::size_t i = 0; i < N; ++i)
+		mask |= static_cast<std::uint32_t>(x.v[i] <= y.v[i]) << i;
+	return mask;
+}
+
+template <std::size_t N>
+inline std::uint32_t notEqual(const ScalarLanes<N>& x, const ScalarLanes<N>& y)
+{
+	std::uint32_t mask = 0;
+	for (std::size_t i = 0; i < N; ++i)
+		mask |= static_cast<std::uint32_t>(x.v[i] != y.v[i]) << i;
+	return mask;
+}
+
+template <std::size_t N>
+inline ScalarLanes<N> select(std::uint32_t mask, const ScalarLanes<N>& x, const ScalarLanes<N>& y)
+{
+	ScalarLanes<N> result;
+	for (std::size_t i = 0; i < N; ++i)
+		result.v[i] = ((mask >> i) & 1) ? x.v[i] : y.v[i];
+	return result;
+}
+
+inline std::uint32_t bits(std::uint32_t mask)
+{
+	return mask;
+}
+
+#if defined(EMERGENT_PACKET_LANES_SSE)
+
+/**
+ * Four packet lanes stored in an SSE register.
+ */
+struct SSELanes
+{
+	struct Mask
+	{
+		__m128 m;
+	};
+
+	static constexpr std::size_t width = 4;
+
+	SSELanes() = default;
+	explicit SSELanes(__m128 x): v(x) {}
+	explicit SSELanes(float x): v(_mm_set1_ps(x)) {}
+
+	static SSELanes load(const float* x)
+	{
+		return SSELanes(_mm_load_ps(x));
+	}
+
+	static SSELanes loadUnaligned(const float* x)
+	{
+		return SSELanes(_mm_loadu_ps(x));
+	}
+
+	void store(float* x) const
+	{
+		_mm_storeu_ps(x, v);
+	}
+
+	__m128 v;
+};
+
+inline SSELanes operator+(const SSELanes& x, const SSELanes& y) { return SSELanes(_mm_add_ps(x.v, y.v)); }
+inline SSELanes operator-(const SSELanes& x, const SSELanes& y) { return SSELanes(_mm_sub_ps(x.v, y.v)); }
+inline SSELanes operator*(const SSELanes& x, const SSELanes& y) { return SSELanes(_mm_mul_ps(x.v, y.v)); }
+inline SSELanes operator/(const SSELanes& x, const SSELanes& y) { return SSELanes(_mm_div_ps(x.v, y.v)); }
+inline SSELanes min(const SSELanes& x, const SSELanes& y) { return SSELanes(_mm_min_ps(x.v, y.v)); }
+inline SSELanes max(const SSELanes& x, const SSELanes& y) { return SSELanes(_mm_max_ps(x.v, y.v)); }
+inline SSELanes::Mask lessThan(const SSELanes& x, const SSELanes& y) { return {_mm_cmplt_ps(x.v, y.v)}; }
+inline SSELanes::Mask lessThanEqual(const SSELanes& x, const SSELanes& y) { return {_mm_cmple_ps(x.v, y.v)}; }
+inline SSELanes::Mask notEqual(const SSELanes& x, const SSELanes& y) { return {_mm_cmpneq_ps(x.v, y.v)}; }
+inline SSELanes::Mask operator&(const SSELanes::Mask& x, const SSELanes::Mask& y) { return {_mm_and_ps(x.m, y.m)}; }
+inline std::uint32_t bits(const SSELanes::Mask& mask) { return static_cast<std::uint32_t>(_mm_movemask_ps(mask.m)); }
+inline SSELanes select(const SSELanes::Mask& mask, const SSELanes& x, const SSELanes& y) { return SSELanes(_mm_or_ps(_mm_and_ps(mask.m, x.v), _mm_andnot_ps(mask.m, y.v))); }
+
+typedef SSELanes Lanes4;
+
+#else
+
+typedef ScalarLanes<4> Lanes4;
+
+#endif // EMERGENT_PACKET_LANES_SSE
+
+#if defined(EMERGENT_PACKET_LANES_AVX)
+
+/**
+ * Eight packet lanes stored in an AVX register.
+ */
+struct AVXLanes
+{
+	struct Mask
+	{
+		__m256 m;
+	};
+
+	static constexpr std::size_t width = 8;
+
+	AVXLanes() = default;
+	explicit AVXLanes(__m256 x): v(x) {}
+	explicit AVXLanes(float x): v(_mm256_set1_ps(x)) {}
+
+	static AVXLanes load(const float* x)
+	{
+		return AVXLanes(_mm256_load_ps(x));
+	}
+
+	static AVXLanes loadUnaligned(const float* x)
+	{
+		return AVXLanes(_mm256_loadu_ps(x));
+	}
+
+	void store(float* x) const
+	{
+		_mm256_storeu_ps(x, v);
+	}
+
+	__m256 v;
+};
+
+inline AVXLanes operator+(const AVXLanes& x, const AVXLanes& y) { return AVXLanes(_mm256_add_ps(x.v, y.v)); }
+inline AVXLanes operator-(const AVXLanes& x, const AVXLanes& y) { return AVXLanes(_mm256_sub_ps(x.v, y.v)); }
+inline AVXLanes operator*(const AVXLanes& x, const AVXLanes& y) { return AVXLanes(_mm256_mul_ps(x.v, y.v)); }
+inline AVXLanes operator/(const AVXLanes& x, const AVXLanes& y) { return AVXLanes(_mm256_div_ps(x.v, y.v)); }
+inline AVXLanes min(const AVXLanes& x, const AVXLanes& y) { return AVXLanes(_mm256_min_ps(x.v, y.v)); }
+inline AVXLanes max(const AVXLanes& x, const AVXLanes& y) { return AVXLanes(_mm256_max_ps(x.v, y.v)); }
+inline AVXLanes::Mask lessThan(const AVXLanes& x, const AVXLanes& y) { return {_mm256_cmp_ps(x.v, y.v, _CMP_LT_OQ)}; }
+inline AVXLanes::Mask lessThanEqual(const AVXLanes& x, const AVXLanes& y) { return {_mm256_cmp_ps(x.v, y.v, _CMP_LE_OQ)}; }
+inline AVXLanes::Mask notEqual(const AVXLanes& x, const AVXLanes& y) { return {_mm256_cmp_ps(x.v, y.v, _CMP_NEQ_UQ)}; }
+inline AVXLanes::Mask operator&(const AVXLanes::Mask& x, const AVXLanes::Mask& y) { return {_mm256_and_ps(x.m, y.m)}; }
+inline std::uint32_t bits(const AVXLanes::Mask& mask) { return static_cast<std::uint32_t>(_mm256_movemask_ps(mask.m)); }
+inline AVXLanes select(const AVXLanes::Mask& mask, const AVXLanes& x, const AVXLanes& y) { return AVXLanes(_mm256_blendv_ps(y.v, x.v, mask.m)); }
+
+typedef AVXLanes Lanes8;
+typedef AVXLanes WideLanes;
+
+#else
+
+typedef ScalarLanes<8> Lanes8;
+typedef Lanes4 WideLanes;
+
+#endif // EMERGENT_PACKET_LANES_AVX
+
+/// Selects the packet lane type for a packet width
+template <std::size_t N>
+struct PacketLanes;
+
+template <>
+struct PacketLanes<4>
+{
+	typedef Lanes4 Type;
+};
+
+template <>
+struct PacketLanes<8>
+{
+	typedef Lanes8 Type;
+};
+
+} // namespace Emergent
+
+#endif // EMERGENT_GEOMETRY_PACKET_LANES_HPP
@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) 2017-2019  Christopher J. Howard
+ *
+ * This file is part of Emergent.
+ *
+ * Emergent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Emergent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Emergent.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <emergent/geometry/ray-packet.hpp>
+#include <emergent/geometry/aabb.hpp>
+#include <emergent/geometry/ray.hpp>
+#include <emergent/geometry/packet-lanes.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Emergent
+{
+
+/**
+ * Möller–Trumbore ray-triangle test, evaluated across packet lanes. Operations are performed in the same order as Ray::intersects(const Vector3&, const Vector3&, const Vector3&) const so that results match the scalar test.
+ */
+template <class L>
+inline std::uint32_t intersectTriangles(const L& originX, const L& originY, const L& originZ, const L& directionX, const L& directionY, const L& directionZ, const L& tmax, const L& ax, const L& ay, const L& az, const L& edge10x, const L& edge10y, const L& edge10z, const L& edge20x, const L& edge20y, const L& edge20z, float* t)
+{
+	const L zero(0.0f);
+	const L one(1.0f);
+
+	// Calculate determinant
+	L pvx = directionY * edge20z - edge20y * directionZ;
+	L pvy = directionZ * edge20x - edge20z * directionX;
+	L pvz = directionX * edge20y - edge20x * directionY;
+	L det = edge10x * pvx + edge10y * pvy + edge10z * pvz;
+	L inverseDet = one / det;
+
+	// Calculate u
+	L tvx = originX - ax;
+	L tvy = originY - ay;
+	L tvz = originZ - az;
+	L u = (tvx * pvx + tvy * pvy + tvz * pvz) * inverseDet;
+
+	// Calculate v
+	L qvx = tvy * edge10z - edge10y * tvz;
+	L qvy = tvz * edge10x - edge10z * tvx;
+	L qvz = tvx * edge10y - edge10x * tvy;
+	L v = (directionX * qvx + directionY * qvy + directionZ * qvz) * inverseDet;
+
+	// Calculate t
+	L distance = (edge20x * qvx + edge20y * qvy + edge20z * qvz) * inverseDet;
+	distance.store(t);
+
+	return bits(notEqual(det, zero)
+		& lessThanEqual(zero, u) & lessThanEqual(u, one)
+		& lessThanEqual(zero, v) & lessThanEqual(u + v, one)
+		& lessThan(zero, distance) & lessThanEqual(distance, tmax));
+}
+
+/**
+ * Ray-AABB slab test, evaluated across packet lanes.
+ *
+ * A ray which is parallel to a slab and whose origin lies on one of its planes yields `0 * inf = NaN` for that plane, yet stays inside the slab. Lane min() and max() return their second operand when compared with NaN, so the accumulated interval is always passed second, and the bounds of each slab are ordered so that such a slab yields NaN, which is then ignored, rather than an infinite bound on the wrong side.
+ */
+template <class L>
+inline std::uint32_t intersectAABBs(const L& originX, const L& originY, const L& originZ, const L& inverseDirectionX, const L& inverseDirectionY, const L& inverseDirectionZ, const L& tmax, const L& minX, const L& minY, const L& minZ, const L& maxX, const L& maxY, const L& maxZ, float* t)
+{
+	L tx0 = (minX - originX) * inverseDirectionX;
+	L tx1 = (maxX - originX) * inverseDirectionX;
+	L ty0 = (minY - originY) * inverseDirectionY;
+	L ty1 = (maxY - originY) * inverseDirectionY;
+	L tz0 = (minZ - originZ) * inverseDirectionZ;
+	L tz1 = (maxZ - originZ) * inverseDirectionZ;
+
+	L t0 = max(min(tz1, tz0), max(min(ty1, ty0), max(min(tx1, tx0), L(0.0f))));
+	L t1 = min(max(tz0, tz1), min(max(ty0, ty1), min(max(tx0, tx1), tmax)));
+	t0.store(t);
+
+	// Inverted boxes, such as cleared lanes, never intersect
+	return bits(lessThanEqual(t0, t1) & lessThanEqual(minX, maxX));
+}
+
+/**
+ * Calculates the reciprocal of a ray direction component. Infinite reciprocals, including that of negative zero, are made positive, which intersectAABBs() relies on.
+ */
+inline float inverseComponent(float x)
+{
+	float inverse = 1.0f / x;
+	return (std::isinf(inverse)) ? std::numeric_limits<float>::infinity() : inverse;
+}
+
+template <std::size_t N>
+std::uint32_t intersects(const Ray& ray, const TrianglePacket<N>& triangles, float tmax, float* t)
+{
+	typedef typename PacketLanes<N>::Type L;
+
+	return intersectTriangles<L>(
+		L(ray.origin.x), L(ray.origin.y), L(ray.origin.z),
+		L(ray.direction.x), L(ray.direction.y), L(ray.direction.z),
+		L(tmax),
+		L::load(triangles.ax), L::load(triangles.ay), L::load(triangles.az),
+		L::load(triangles.edge10x), L::load(triangles.edge10y), L::load(triangles.edge10z),
+		L::load(triangles.edge20x), L::load(triangles.edge20y), L::load(triangles.edge20z),
+		t);
+}
+
+template <std::size_t N>
+std::uint32_t intersects(const Ray& ray, const AABBPacket<N>& aabbs, float tmax, float* t)
+{
+	typedef typename PacketLanes<N>::Type L;
+
+	return intersectAABBs<L>(
+		L(ray.origin.x), L(ray.origin.y), L(ray.origin.z),
+		L(inverseComponent(ray.direction.x)), L(inverseComponent(ray.direction.y)), L(inverseComponent(ray.direction.z)),
+		L(tmax),
+		L::load(aabbs.minX), L::load(aabbs.minY), L::load(aabbs.minZ),
+		L::load(aabbs.maxX), L::load(aabbs.maxY), L::load(aabbs.maxZ),
+		t);
+}
+
+template <std::size_t N>
+std::uint32_t intersects(const RayPacket<N>& rays, const Vector3& a, const Vector3& b, const Vector3& c, float* t)
+{
+	typedef typename PacketLanes<N>::Type L;
+
+	Vector3 edge10 = b - a;
+	Vector3 edge20 = c - a;
+
+	return intersectTriangles<L>(
+		L::load(rays.originX), L::load(rays.originY), L::load(rays.originZ),
+		L::load(rays.directionX), L::load(rays.directionY), L::load(rays.directionZ),
+		L::load(rays.tmax),
+		L(a.x), L(a.y), L(a.z),
+		L(edge10.x), L(edge10.y), L(edge10.z),
+		L(edge20.x), L(edge20.y), L(edge20.z),
+		t);
+}
+
+template <std::size_t N>
+std::uint32_t intersects(const RayPacket<N>& rays, const AABB& aabb, float* t)
+{
+	typedef typename PacketLanes<N>::Type L;
+
+	const Vector3& minPoint = aabb.getMin();
+	const Vector3& maxPoint = aabb.getMax();
+
+	return intersectAABBs<L>(
+		L::load(rays.originX), L::load(rays.originY), L::load(rays.originZ),
+		L::load(rays.inverseDirectionX), L::load(rays.inverseDirectionY), L::load(rays.inverseDirectionZ),
+		L::load(rays.tmax),
+		L(minPoint.x), L(minPoint.y), L(minPoint.z),
+		L(maxPoint.x), L(maxPoint.y), L(maxPoint.z),
+		t);
+}
+
+template std::uint32_t intersects<4>(const Ray&, const TrianglePacket<4>&, float, float*);
+template std::uint32_t intersects<8>(const Ray&, const TrianglePacket<8>&, float, float*);
+template std::uint32_t intersects<4>(const Ray&, const AABBPacket<4>&, float, float*);
+template std::uint32_t intersects<8>(const Ray&, const AABBPacket<8>&, float, float*);
+template std::uint32_t intersects<4>(const RayPacket<4>&, const Vector3&, const Vector3&, const Vector3&, float*);
+template std::uint32_t intersects<8>(const RayPacket<8>&, const Vector3&, const Vector3&, const Vector3&, float*);
+template std::uint32_t intersects<4>(const RayPacket<4>&, const AABB&, float*);
+template std::uint32_t intersects<8>(const RayPacket<8>&, const AABB&, float*);
+
+} // namespace Emergent
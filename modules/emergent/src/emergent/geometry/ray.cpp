@@ -18,9 +18,11 @@
  */
 
 #include <emergent/geometry/ray.hpp>
+#include <emergent/geometry/ray-packet.hpp>
 #include <emergent/geometry/plane.hpp>
 #include <emergent/geometry/sphere.hpp>
 #include <emergent/geometry/aabb.hpp>
+#include <emergent/geometry/obb.hpp>
 #include <emergent/geometry/convex-hull.hpp>
 #include <emergent/geometry/bounding-volume.hpp>
 #include <emergent/geometry/triangle-mesh.hpp>
@@ -104,6 +106,16 @@ std::tuple<bool, float, float> Ray::intersects(const AABB& aabb) const
 	return std::make_tuple(true, t0, t1);
 }
 
+std::tuple<bool, float, float> Ray::intersects(const OBB& obb) const
+{
+	// Intersect the ray in the frame of the box, which preserves distances along the ray
+	Ray local;
+	local.origin = (origin - obb.getCenter()) * obb.getAxes();
+	local.direction = direction * obb.getAxes();
+	
+	return local.intersects(AABB(-obb.getExtents(), obb.getExtents()));
+}
+
 std::tuple<bool, float, float> Ray::intersects(const ConvexHull& hull) const
 {
 	float t0 = -std::numeric_limits<float>::infinity();
@@ -146,6 +158,10 @@ std::tuple<bool, float, float> Ray::intersects(const BoundingVolume& bv) const
 			return intersects(static_cast<const AABB&>(bv));
 			break;
 		
+		case BoundingVolume::Type::OBB:
+			return intersects(static_cast<const OBB&>(bv));
+			break;
+		
 		case BoundingVolume::Type::CONVEX_HULL:
 			return intersects(static_cast<const ConvexHull&>(bv));
 			break;
@@ -205,7 +221,7 @@ std::tuple<bool, float, float, float> Ray::intersects(const Vector3& a, const Ve
 
 std::tuple<bool, float, float, std::size_t, std::size_t> Ray::intersects(const TriangleMesh& mesh) const
 {
-	const std::vector<TriangleMesh::Triangle*>& triangles = *mesh.getTriangles();
+	const std::vector<TriangleMesh::Triangle>& triangles = *mesh.getTriangles();
 	
 	bool intersection = false;
 	float t0 = std::numeric_limits<float>::infinity();
@@ -213,33 +229,57 @@ std::tuple<bool, float, float, std::size_t, std::size_t> Ray::intersects(const T
 	std::size_t index0 = triangles.size();
 	std::size_t index1 = triangles.size();
 
-	for (std::size_t i = 0; i < triangles.size(); ++i)
+	// Test triangles four at a time
+	TrianglePacket<4> packet;
+	for (std::size_t i = 0; i < triangles.size(); i += 4)
 	{
-		const TriangleMesh::Triangle* triangle = triangles[i];
-		const Vector3& a = triangle->edge->vertex->position;
-		const Vector3& b = triangle->edge->next->vertex->position;
-		const Vector3& c = triangle->edge->previous->vertex->position;
-		
-		auto result = intersects(a, b, c);
+		for (std::size_t j = 0; j < 4; ++j)
+		{
+			if (i + j < triangles.size())
+			{
+				std::uint32_t edge = TriangleMesh::getEdge(static_cast<std::uint32_t>(i + j));
+				const Vector3& a = mesh.getPosition(edge);
+				const Vector3& b = mesh.getPosition(edge + 1);
+				const Vector3& c = mesh.getPosition(edge + 2);
+				packet.set(j, a, b, c);
+			}
+			else
+			{
+				packet.clear(j);
+			}
+		}
+
+		float t[4];
+		std::uint32_t mask = Emergent::intersects(*this, packet, std::numeric_limits<float>::infinity(), t);
 		
-		if (std::get<0>(result))
+		for (std::size_t j = 0; j < 4; ++j)
 		{
+			if (!((mask >> j) & 1))
+			{
+				continue;
+			}
+
 			intersection = true;
 
-			float t = std::get<1>(result);
-			float cosTheta = glm::dot(direction, triangle->normal);	
+			float cosTheta = glm::dot(direction, triangles[i + j].normal);
 
 			if (cosTheta <= 0.0f)
 			{
 				// Front-facing
-				t0 = std::min(t0, t);
-				index0 = i;
+				if (t[j] < t0)
+				{
+					t0 = t[j];
+					index0 = i + j;
+				}
 			}
 			else
 			{
 				// Back-facing
-				t1 = std::max(t1, t);
-				index1 = i;
+				if (t[j] > t1)
+				{
+					t1 = t[j];
+					index1 = i + j;
+				}
 			}
 		}
 	}
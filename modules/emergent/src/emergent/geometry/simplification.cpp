@@ -0,0 +1,353 @@
+/*
+ * Copyright (C) 2017-2019  Christopher J. Howard
+ *
+ * This file is part of Emergent.
+ *
+ * Emergent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Emergent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Emergent.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <emergent/geometry/simplification.hpp>
+#include <emergent/geometry/triangle-mesh.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <queue>
+
+namespace Emergent
+{
+
+namespace
+{
+
+/// Symmetric 4x4 matrix which measures the sum of squared distances from a point to a set of planes.
+struct Quadric
+{
+	double a00, a01, a02, a03;
+	double a11, a12, a13;
+	double a22, a23;
+	double a33;
+	
+	void addPlane(const Vector3& normal, double distance, double weight)
+	{
+		double x = normal.x, y = normal.y, z = normal.z;
+		a00 += weight * x * x; a01 += weight * x * y; a02 += weight * x * z; a03 += weight * x * distance;
+		a11 += weight * y * y; a12 += weight * y * z; a13 += weight * y * distance;
+		a22 += weight * z * z; a23 += weight * z * distance;
+		a33 += weight * distance * distance;
+	}
+	
+	void add(const Quadric& q)
+	{
+		a00 += q.a00; a01 += q.a01; a02 += q.a02; a03 += q.a03;
+		a11 += q.a11; a12 += q.a12; a13 += q.a13;
+		a22 += q.a22; a23 += q.a23;
+		a33 += q.a33;
+	}
+	
+	/// Evaluates the sum of this quadric and another quadric at a point.
+	double evaluate(const Quadric& q, const Vector3& p) const
+	{
+		double x = p.x, y = p.y, z = p.z;
+		return (a00 + q.a00) * x * x + 2.0 * (a01 + q.a01) * x * y + 2.0 * (a02 + q.a02) * x * z + 2.0 * (a03 + q.a03) * x
+			+ (a11 + q.a11) * y * y + 2.0 * (a12 + q.a12) * y * z + 2.0 * (a13 + q.a13) * y
+			+ (a22 + q.a22) * z * z + 2.0 * (a23 + q.a23) * z
+			+ (a33 + q.a33);
+	}
+};
+
+/// Candidate collapse of one vertex into another, tagged with the versions of both vertices at the time its cost was calculated.
+struct Collapse
+{
+	double cost;
+	std::uint32_t from;
+	std::uint32_t to;
+	std::uint32_t fromVersion;
+	std::uint32_t toVersion;
+	
+	bool operator>(const Collapse& other) const
+	{
+		return cost > other.cost;
+	}
+};
+
+} // namespace
+
+void simplify(const TriangleMesh& mesh, std::size_t levelCount, float reduction, std::vector<std::vector<std::size_t>>* levels)
+{
+	// Relative weight of the planes which preserve open borders
+	const double boundaryWeight = 10.0;
+	
+	// Cosine of the largest rotation a collapse may apply to a triangle normal
+	const float maxNormalDeviation = 0.25f;
+	
+	levels->clear();
+	
+	const std::vector<TriangleMesh::Vertex>& vertices = *mesh.getVertices();
+	const std::vector<TriangleMesh::Edge>& edges = *mesh.getEdges();
+	std::size_t vertexCount = vertices.size();
+	std::size_t triangleCount = mesh.getTriangles()->size();
+	
+	std::vector<std::uint32_t> indices(edges.size());
+	for (std::size_t i = 0; i < edges.size(); ++i)
+	{
+		indices[i] = edges[i].vertex;
+	}
+	
+	// Accumulate the area-weighted plane quadrics of each vertex, and build vertex-triangle adjacency
+	std::vector<Quadric> quadrics(vertexCount, Quadric{});
+	std::vector<std::vector<std::uint32_t>> adjacency(vertexCount);
+	std::vector<bool> alive(triangleCount, true);
+	
+	auto getNormal = [&](std::uint32_t triangle) -> Vector3
+	{
+		const Vector3& a = vertices[indices[triangle * 3]].position;
+		const Vector3& b = vertices[indices[triangle * 3 + 1]].position;
+		const Vector3& c = vertices[indices[triangle * 3 + 2]].position;
+		return glm::cross(b - a, c - a);
+	};
+	
+	for (std::uint32_t i = 0; i < triangleCount; ++i)
+	{
+		Vector3 normal = getNormal(i);
+		float length = glm::length(normal);
+		if (length > 0.0f)
+		{
+			normal /= length;
+			double distance = -glm::dot(normal, vertices[indices[i * 3]].position);
+			for (int j = 0; j < 3; ++j)
+			{
+				quadrics[indices[i * 3 + j]].addPlane(normal, distance, length * 0.5);
+			}
+			
+			// Constrain open borders with planes perpendicular to the triangle
+			for (std::uint32_t e = i * 3; e < i * 3 + 3; ++e)
+			{
+				if (edges[e].symmetric != TriangleMesh::invalidIndex)
+				{
+					continue;
+				}
+				
+				const Vector3& a = vertices[indices[e]].position;
+				const Vector3& b = vertices[indices[TriangleMesh::getNext(e)]].position;
+				Vector3 border = glm::cross(b - a, normal);
+				float borderLength = glm::length(border);
+				if (borderLength > 0.0f)
+				{
+					border /= borderLength;
+					double borderDistance = -glm::dot(border, a);
+					quadrics[indices[e]].addPlane(border, borderDistance, boundaryWeight * borderLength * borderLength);
+					quadrics[indices[TriangleMesh::getNext(e)]].addPlane(border, borderDistance, boundaryWeight * borderLength * borderLength);
+				}
+			}
+		}
+		
+		for (int j = 0; j < 3; ++j)
+		{
+			adjacency[indices[i * 3 + j]].push_back(i);
+		}
+	}
+	
+	std::vector<std::uint32_t> versions(vertexCount, 0);
+	std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> queue;
+	
+	// Queues the cheaper direction of collapse for an edge
+	auto queueEdge = [&](std::uint32_t a, std::uint32_t b)
+	{
+		double costA = quadrics[a].evaluate(quadrics[b], vertices[b].position);
+		double costB = quadrics[a].evaluate(quadrics[b], vertices[a].position);
+		if (costA <= costB)
+		{
+			queue.push({costA, a, b, versions[a], versions[b]});
+		}
+		else
+		{
+			queue.push({costB, b, a, versions[b], versions[a]});
+		}
+	};
+	
+	for (std::uint32_t e = 0; e < edges.size(); ++e)
+	{
+		if (edges[e].symmetric == TriangleMesh::invalidIndex || e < edges[e].symmetric)
+		{
+			queueEdge(indices[e], indices[TriangleMesh::getNext(e)]);
+		}
+	}
+	
+	// Vertex marks used to intersect the one-rings of the two vertices of a collapse
+	std::vector<std::uint32_t> marks(vertexCount, 0);
+	std::uint32_t mark = 0;
+	
+	// Checks whether collapsing a vertex into another preserves manifoldness and triangle orientations
+	auto isValid = [&](std::uint32_t from, std::uint32_t to) -> bool
+	{
+		// Mark the one-ring of the remaining vertex
+		++mark;
+		for (std::uint32_t triangle: adjacency[to])
+		{
+			if (alive[triangle])
+			{
+				for (int j = 0; j < 3; ++j)
+				{
+					marks[indices[triangle * 3 + j]] = mark;
+				}
+			}
+		}
+		
+		std::size_t sharedTriangles = 0;
+		std::size_t sharedVertices = 0;
+		++mark;
+		for (std::uint32_t triangle: adjacency[from])
+		{
+			if (!alive[triangle])
+			{
+				continue;
+			}
+			
+			// Count the vertices in the one-rings of both vertices
+			std::uint32_t* triangleIndices = &indices[triangle * 3];
+			for (int j = 0; j < 3; ++j)
+			{
+				std::uint32_t vertex = triangleIndices[j];
+				if (vertex != from && vertex != to && marks[vertex] == mark - 1)
+				{
+					marks[vertex] = mark;
+					++sharedVertices;
+				}
+			}
+			
+			if (triangleIndices[0] == to || triangleIndices[1] == to || triangleIndices[2] == to)
+			{
+				++sharedTriangles;
+				continue;
+			}
+			
+			// Reject collapses which flip, degenerate, or sharply rotate the triangle
+			Vector3 oldNormal = getNormal(triangle);
+			for (int j = 0; j < 3; ++j)
+			{
+				if (triangleIndices[j] == from)
+				{
+					triangleIndices[j] = to;
+					Vector3 newNormal = getNormal(triangle);
+					triangleIndices[j] = from;
+					
+					if (glm::dot(oldNormal, newNormal) <= maxNormalDeviation * glm::length(oldNormal) * glm::length(newNormal))
+					{
+						return false;
+					}
+				}
+			}
+		}
+		
+		// The one-rings of the two vertices may only share the vertices opposite the collapsed edge
+		return sharedTriangles > 0 && sharedVertices == sharedTriangles;
+	};
+	
+	std::size_t aliveCount = triangleCount;
+	std::vector<std::uint32_t> neighbors;
+	
+	for (std::size_t level = 0; level < levelCount; ++level)
+	{
+		std::size_t target = static_cast<std::size_t>(static_cast<double>(aliveCount) * reduction);
+		std::size_t previousCount = aliveCount;
+		
+		while (aliveCount > target && !queue.empty())
+		{
+			Collapse collapse = queue.top();
+			queue.pop();
+			
+			std::uint32_t from = collapse.from;
+			std::uint32_t to = collapse.to;
+			if (collapse.fromVersion != versions[from] || collapse.toVersion != versions[to] || !isValid(from, to))
+			{
+				continue;
+			}
+			
+			// Merge the quadric and triangles of the collapsed vertex into the remaining vertex, removing the triangles which shared both
+			quadrics[to].add(quadrics[from]);
+			++versions[from];
+			++versions[to];
+			
+			for (std::uint32_t triangle: adjacency[from])
+			{
+				if (!alive[triangle])
+				{
+					continue;
+				}
+				
+				std::uint32_t* triangleIndices = &indices[triangle * 3];
+				if (triangleIndices[0] == to || triangleIndices[1] == to || triangleIndices[2] == to)
+				{
+					alive[triangle] = false;
+					--aliveCount;
+					continue;
+				}
+				
+				for (int j = 0; j < 3; ++j)
+				{
+					if (triangleIndices[j] == from)
+					{
+						triangleIndices[j] = to;
+					}
+				}
+				adjacency[to].push_back(triangle);
+			}
+			adjacency[from].clear();
+			adjacency[from].shrink_to_fit();
+			
+			std::vector<std::uint32_t>& toAdjacency = adjacency[to];
+			toAdjacency.erase(std::remove_if(toAdjacency.begin(), toAdjacency.end(), [&](std::uint32_t triangle) { return !alive[triangle]; }), toAdjacency.end());
+			
+			// Requeue the edges of the remaining vertex with their new costs
+			++mark;
+			neighbors.clear();
+			for (std::uint32_t triangle: toAdjacency)
+			{
+				for (int j = 0; j < 3; ++j)
+				{
+					std::uint32_t vertex = indices[triangle * 3 + j];
+					if (vertex != to && marks[vertex] != mark)
+					{
+						marks[vertex] = mark;
+						neighbors.push_back(vertex);
+					}
+				}
+			}
+			for (std::uint32_t vertex: neighbors)
+			{
+				queueEdge(to, vertex);
+			}
+		}
+		
+		if (aliveCount == previousCount)
+		{
+			break;
+		}
+		
+		// Store the remaining triangles as a level of detail
+		levels->emplace_back();
+		std::vector<std::size_t>& levelIndices = levels->back();
+		levelIndices.reserve(aliveCount * 3);
+		for (std::size_t i = 0; i < triangleCount; ++i)
+		{
+			if (alive[i])
+			{
+				levelIndices.insert(levelIndices.end(), indices.begin() + i * 3, indices.begin() + i * 3 + 3);
+			}
+		}
+	}
+}
+
+} // namespace Emergent
+
@@ -19,11 +19,18 @@
 
 #include <emergent/geometry/sphere.hpp>
 #include <emergent/geometry/aabb.hpp>
+#include <emergent/geometry/obb.hpp>
 #include <algorithm>
 
 namespace Emergent
 {
 
+Sphere Sphere::transformed(const Transform& transform) const
+{
+	Vector3 scale = glm::abs(transform.scale);
+	return Sphere(transform.transform(center), radius * std::max(scale.x, std::max(scale.y, scale.z)));
+}
+
 bool Sphere::intersects(const Sphere& sphere) const
 {
 	Vector3 d = center - sphere.center;
@@ -36,6 +43,11 @@ bool Sphere::intersects(const AABB& aabb) const
 	return aabb.intersects(*this);
 }
 
+bool Sphere::intersects(const OBB& obb) const
+{
+	return obb.intersects(*this);
+}
+
 bool Sphere::contains(const Vector3& point) const
 {
 	Vector3 d = center - point;
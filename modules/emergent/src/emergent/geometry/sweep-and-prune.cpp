@@ -0,0 +1,361 @@
+/*
+ * Copyright (C) 2017-2019  Christopher J. Howard
+ *
+ * This file is part of Emergent.
+ *
+ * Emergent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Emergent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Emergent.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+
+#include <emergent/geometry/sweep-and-prune.hpp>
+#include <algorithm>
+
+namespace Emergent
+{
+
+namespace
+{
+
+/// Maximum number of boxes inserted between two steps before the endpoints are sorted from scratch rather than with insertion sort.
+const std::size_t maxIncrementalInsertions = 32;
+
+inline bool isMax(std::uint32_t data)
+{
+	return (data & 1) != 0;
+}
+
+/// Orders endpoints by value, with minimum endpoints before maximum endpoints of equal value so that touching boxes overlap.
+template <typename T>
+inline bool precedes(const T& a, const T& b)
+{
+	return a.value < b.value || (a.value == b.value && !isMax(a.data) && isMax(b.data));
+}
+
+} // namespace
+
+SweepAndPrune::SweepAndPrune():
+	boxCount(0),
+	insertionCount(0)
+{}
+
+SweepAndPrune::HandleType SweepAndPrune::insert(const AABB& bounds)
+{
+	HandleType handle;
+	if (!freeHandles.empty())
+	{
+		handle = freeHandles.back();
+		freeHandles.pop_back();
+		active[handle] = true;
+		pairCounts[handle] = 0;
+	}
+	else
+	{
+		handle = static_cast<HandleType>(active.size());
+		active.push_back(true);
+		for (std::size_t axis = 0; axis < 3; ++axis)
+		{
+			extents[axis].resize(extents[axis].size() + 2);
+		}
+		pairCounts.push_back(0);
+	}
+
+	update(handle, bounds);
+	for (std::size_t axis = 0; axis < 3; ++axis)
+	{
+		endpoints[axis].push_back({bounds.getMin()[axis], handle << 1});
+		endpoints[axis].push_back({bounds.getMax()[axis], (handle << 1) | 1});
+	}
+
+	++boxCount;
+	++insertionCount;
+
+	return handle;
+}
+
+void SweepAndPrune::remove(HandleType handle)
+{
+	active[handle] = false;
+	removedHandles.push_back(handle);
+	--boxCount;
+}
+
+void SweepAndPrune::update(HandleType handle, const AABB& bounds)
+{
+	for (std::size_t axis = 0; axis < 3; ++axis)
+	{
+		extents[axis][handle << 1] = bounds.getMin()[axis];
+		extents[axis][(handle << 1) | 1] = bounds.getMax()[axis];
+	}
+}
+
+void SweepAndPrune::step(std::vector<PairType>* added, std::vector<PairType>* removed)
+{
+	if (!removedHandles.empty())
+	{
+		// Drop the endpoints of removed boxes
+		for (std::size_t axis = 0; axis < 3; ++axis)
+		{
+			endpoints[axis].erase(std::remove_if(endpoints[axis].begin(), endpoints[axis].end(),
+				[this](const Endpoint& endpoint)
+				{
+					return !active[endpoint.data >> 1];
+				}), endpoints[axis].end());
+		}
+
+		// Drop the pairs of removed boxes
+		for (auto it = pairs.begin(); it != pairs.end();)
+		{
+			HandleType a = static_cast<HandleType>(*it >> 32);
+			HandleType b = static_cast<HandleType>(*it);
+			if (!active[a] || !active[b])
+			{
+				--pairCounts[a];
+				--pairCounts[b];
+				changes.emplace(*it, true);
+				it = pairs.erase(it);
+			}
+			else
+			{
+				++it;
+			}
+		}
+	}
+
+	// Refresh endpoint values from the current bounds
+	for (std::size_t axis = 0; axis < 3; ++axis)
+	{
+		const float* axisExtents = extents[axis].data();
+		for (Endpoint& endpoint: endpoints[axis])
+		{
+			endpoint.value = axisExtents[endpoint.data];
+		}
+	}
+
+	if (insertionCount > maxIncrementalInsertions)
+	{
+		rebuild();
+	}
+	else
+	{
+		for (std::size_t axis = 0; axis < 3; ++axis)
+		{
+			sortAxis(axis);
+		}
+	}
+
+	// Report the net change of each pair touched during this step
+	for (const auto& change: changes)
+	{
+		bool present = (pairs.find(change.first) != pairs.end());
+		if (present == change.second)
+		{
+			continue;
+		}
+
+		PairType pair(static_cast<HandleType>(change.first >> 32), static_cast<HandleType>(change.first));
+		if (present)
+		{
+			if (added != nullptr)
+			{
+				added->push_back(pair);
+			}
+		}
+		else if (removed != nullptr)
+		{
+			removed->push_back(pair);
+		}
+	}
+	changes.clear();
+
+	// Handles of removed boxes may now be reused
+	freeHandles.insert(freeHandles.end(), removedHandles.begin(), removedHandles.end());
+	removedHandles.clear();
+	insertionCount = 0;
+}
+
+void SweepAndPrune::clear()
+{
+	active.clear();
+	pairCounts.clear();
+	for (std::size_t axis = 0; axis < 3; ++axis)
+	{
+		extents[axis].clear();
+		endpoints[axis].clear();
+	}
+	pairs.clear();
+	changes.clear();
+	freeHandles.clear();
+	removedHandles.clear();
+	boxCount = 0;
+	insertionCount = 0;
+}
+
+void SweepAndPrune::getPairs(std::vector<PairType>* pairs) const
+{
+	pairs->reserve(pairs->size() + this->pairs.size());
+	for (std::uint64_t key: this->pairs)
+	{
+		pairs->emplace_back(static_cast<HandleType>(key >> 32), static_cast<HandleType>(key));
+	}
+}
+
+bool SweepAndPrune::overlaps(HandleType a, HandleType b) const
+{
+	for (std::size_t axis = 0; axis < 3; ++axis)
+	{
+		const float* axisExtents = extents[axis].data();
+		if (axisExtents[a << 1] > axisExtents[(b << 1) | 1] || axisExtents[b << 1] > axisExtents[(a << 1) | 1])
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void SweepAndPrune::addPair(HandleType a, HandleType b)
+{
+	std::uint64_t key = getPairKey(a, b);
+	if (pairs.insert(key).second)
+	{
+		++pairCounts[a];
+		++pairCounts[b];
+		changes.emplace(key, false);
+	}
+}
+
+void SweepAndPrune::removePair(HandleType a, HandleType b)
+{
+	// Most separating boxes were not overlapping along the other axes either, so skip the lookup for boxes without pairs
+	if (!pairCounts[a] || !pairCounts[b])
+	{
+		return;
+	}
+
+	std::uint64_t key = getPairKey(a, b);
+	if (pairs.erase(key))
+	{
+		--pairCounts[a];
+		--pairCounts[b];
+		changes.emplace(key, true);
+	}
+}
+
+void SweepAndPrune::sortAxis(std::size_t axis)
+{
+	std::vector<Endpoint>& axisEndpoints = endpoints[axis];
+
+	for (std::size_t i = 1; i < axisEndpoints.size(); ++i)
+	{
+		Endpoint endpoint = axisEndpoints[i];
+		if (!precedes(endpoint, axisEndpoints[i - 1]))
+		{
+			continue;
+		}
+
+		HandleType handle = endpoint.data >> 1;
+		std::size_t j = i;
+		do
+		{
+			const Endpoint& previous = axisEndpoints[j - 1];
+			HandleType other = previous.data >> 1;
+
+			if (isMax(endpoint.data))
+			{
+				// A maximum passing a minimum separates the boxes
+				if (!isMax(previous.data))
+				{
+					removePair(handle, other);
+				}
+			}
+			else if (isMax(previous.data) && handle != other && overlaps(handle, other))
+			{
+				// A minimum passing a maximum may begin an overlap
+				addPair(handle, other);
+			}
+
+			axisEndpoints[j] = previous;
+			--j;
+		}
+		while (j > 0 && precedes(endpoint, axisEndpoints[j - 1]));
+
+		axisEndpoints[j] = endpoint;
+	}
+}
+
+void SweepAndPrune::rebuild()
+{
+	for (std::size_t axis = 0; axis < 3; ++axis)
+	{
+		std::sort(endpoints[axis].begin(), endpoints[axis].end(), precedes<Endpoint>);
+	}
+
+	// Sweep along the x-axis, testing each box against the boxes whose x-intervals are open
+	std::unordered_set<std::uint64_t> sweptPairs;
+	sweptPairs.reserve(pairs.size());
+	std::vector<HandleType> open;
+	std::vector<std::size_t> openIndices(active.size());
+	for (const Endpoint& endpoint: endpoints[0])
+	{
+		HandleType handle = endpoint.data >> 1;
+		if (isMax(endpoint.data))
+		{
+			std::size_t index = openIndices[handle];
+			open[index] = open.back();
+			openIndices[open[index]] = index;
+			open.pop_back();
+		}
+		else
+		{
+			for (HandleType other: open)
+			{
+				if (overlaps(handle, other))
+				{
+					sweptPairs.insert(getPairKey(handle, other));
+				}
+			}
+
+			openIndices[handle] = open.size();
+			open.push_back(handle);
+		}
+	}
+
+	for (std::uint64_t key: pairs)
+	{
+		if (sweptPairs.find(key) == sweptPairs.end())
+		{
+			changes.emplace(key, true);
+		}
+	}
+	for (std::uint64_t key: sweptPairs)
+	{
+		if (pairs.find(key) == pairs.end())
+		{
+			changes.emplace(key, false);
+		}
+	}
+
+	pairs.swap(sweptPairs);
+
+	std::fill(pairCounts.begin(), pairCounts.end(), 0);
+	for (std::uint64_t key: pairs)
+	{
+		++pairCounts[key >> 32];
+		++pairCounts[static_cast<HandleType>(key)];
+	}
+}
+
+} // namespace Emergent
+
@@ -18,10 +18,7 @@
  */
 
 #include <emergent/geometry/triangle-mesh.hpp>
-#include <fstream>
-#include <map>
-#include <sstream>
-#include <limits>
+#include <stdexcept>
 
 namespace Emergent
 {
@@ -33,117 +30,106 @@ TriangleMesh::TriangleMesh(const std::vector<Vector3>& vertices, const std::vect
 		throw std::runtime_error("TriangleMesh::TriangleMesh(): index count is not a multuple of 3.");
 	}
 	
+	if (vertices.size() >= invalidIndex || indices.size() >= invalidIndex)
+	{
+		throw std::runtime_error("TriangleMesh::TriangleMesh(): Mesh is too large.");
+	}
+	
 	// Copy vertices
 	this->vertices.resize(vertices.size());
 	for (std::size_t i = 0; i < vertices.size(); ++i)
 	{
-		TriangleMesh::Vertex* vertex = new TriangleMesh::Vertex();
-		vertex->edge = nullptr;
-		vertex->position = vertices[i];
-		vertex->index = i;
-		
-		this->vertices[i] = vertex;
+		this->vertices[i].position = vertices[i];
+		this->vertices[i].edge = invalidIndex;
 	}
 	
-	// Allocate triangles
-	triangles.resize(indices.size() / 3, nullptr);
-	std::size_t currentTriangle = 0;
-	
-	// Load triangles
-	std::map<std::pair<std::size_t, std::size_t>, TriangleMesh::Edge*> edgeMap;
-	for (std::size_t i = 0; i < indices.size(); i += 3)
+	// Load half-edges. Triangle normals are calculated once all edges are known.
+	edges.resize(indices.size());
+	triangles.resize(indices.size() / 3);
+	for (std::size_t i = 0; i < indices.size(); ++i)
 	{
-		std::size_t a = indices[i];
-		std::size_t b = indices[i + 1];
-		std::size_t c = indices[i + 2];
-		
-		if (a >= vertices.size() || b >= vertices.size() || c >= vertices.size())
+		if (indices[i] >= vertices.size())
 		{
 			throw std::runtime_error("TriangleMesh::TriangleMesh(): Mesh contains invalid index.");
 		}
 		
-		// Allocate three edges and a triangle
-		TriangleMesh::Edge* ab = new TriangleMesh::Edge();
-		TriangleMesh::Edge* bc = new TriangleMesh::Edge();
-		TriangleMesh::Edge* ca = new TriangleMesh::Edge();
-		TriangleMesh::Triangle* triangle = new TriangleMesh::Triangle();
-
-		// Set triangle start edge
-		triangle->edge = ab;
-
-		// For each edge in this triangle
-		std::size_t triangleIndices[] = {a, b, c};
-		TriangleMesh::Edge* triangleEdges[] = {ab, bc, ca};
-		for (std::size_t j = 0; j < 3; ++j)
-		{
-			// Set edge properties
-			TriangleMesh::Edge* edge = triangleEdges[j];
-			edge->triangle = triangle;
-			edge->vertex = this->vertices[triangleIndices[j]];
-			edge->previous = triangleEdges[(j + 2) % 3];
-			edge->next = triangleEdges[(j + 1) % 3];
-			edge->symmetric = nullptr;
-
-			// Point vertex to this edge
-			edge->vertex->edge = edge;
-
-			// Check for symmetry
-			std::pair<std::size_t, std::size_t> symmetricPair(triangleIndices[(j + 1) % 3], triangleIndices[j]);
-			std::map<std::pair<std::size_t, std::size_t>, TriangleMesh::Edge*>::iterator it = edgeMap.find(symmetricPair);
-			if (it == edgeMap.end())
-			{
-				// No symmetric edge found, insert this edge into the map
-				std::pair<std::size_t, std::size_t> pair(triangleIndices[j], triangleIndices[(j + 1) % 3]);
-				edgeMap[pair] = edge;
-			}
-			else
-			{
-				// Symmetric edge found, connect
-				edge->symmetric = it->second;
-				it->second->symmetric = edge;
-			}
-		}
-
-		// Set edge indices and add edges to the edge list
-		ab->index = edges.size();
-		edges.push_back(ab);
-		bc->index = edges.size();
-		edges.push_back(bc);
-		ca->index = edges.size();
-		edges.push_back(ca);
+		edges[i].vertex = static_cast<std::uint32_t>(indices[i]);
+		edges[i].symmetric = invalidIndex;
 		
-		// Set triangle index and add triangle to the triangle list
-		triangle->index = currentTriangle;
-		triangles[currentTriangle++] = triangle;
+		// Point vertex to this edge
+		this->vertices[indices[i]].edge = static_cast<std::uint32_t>(i);
 	}
 	
+	connectEdges();
 	calculateNormals();
 }
 
-TriangleMesh::~TriangleMesh()
+void TriangleMesh::connectEdges()
 {
-	for (std::size_t i = 0; i < vertices.size(); ++i)
-		delete vertices[i];
-	for (std::size_t i = 0; i < edges.size(); ++i)
-		delete edges[i];
-	for (std::size_t i = 0; i < triangles.size(); ++i)
-		delete triangles[i];
+	// Count the half-edges which start at each vertex
+	std::vector<std::uint32_t> offsets(vertices.size() + 1, 0);
+	for (const Edge& edge: edges)
+	{
+		++offsets[edge.vertex + 1];
+	}
+	for (std::size_t i = 1; i < offsets.size(); ++i)
+	{
+		offsets[i] += offsets[i - 1];
+	}
+	
+	// Bucket the end vertex and index of each half-edge by its start vertex, in order of increasing edge index
+	struct OutgoingEdge
+	{
+		std::uint32_t end;
+		std::uint32_t edge;
+	};
+	std::vector<OutgoingEdge> outgoing(edges.size());
+	std::vector<std::uint32_t> positions(offsets.begin(), offsets.end() - 1);
+	for (std::uint32_t i = 0; i < edges.size(); ++i)
+	{
+		outgoing[positions[edges[i].vertex]++] = {edges[getNext(i)].vertex, i};
+	}
+	
+	// Finds the first half-edge from one vertex to another
+	auto find = [&](std::uint32_t start, std::uint32_t end) -> std::uint32_t
+	{
+		for (std::uint32_t i = offsets[start]; i < offsets[start + 1]; ++i)
+		{
+			if (outgoing[i].end == end)
+			{
+				return outgoing[i].edge;
+			}
+		}
+		return invalidIndex;
+	};
+	
+	// Connect each half-edge to the first half-edge running in the opposite direction, if the connection is mutual. If duplicate half-edges exist, only the first is connected. The buckets are not modified, so this pass may be split across threads.
+	for (std::uint32_t i = 0; i < edges.size(); ++i)
+	{
+		std::uint32_t start = edges[i].vertex;
+		std::uint32_t end = edges[getNext(i)].vertex;
+		
+		std::uint32_t symmetric = find(end, start);
+		if (symmetric != invalidIndex && find(start, end) == i)
+		{
+			edges[i].symmetric = symmetric;
+		}
+	}
 }
 
 void TriangleMesh::calculateNormals()
 {
-	for (std::size_t i = 0; i < triangles.size(); ++i)
+	for (std::uint32_t i = 0; i < triangles.size(); ++i)
 	{
-		TriangleMesh::Triangle* triangle = triangles[i];
-
 		// Calculate surface normal
-		const Vector3& a = triangle->edge->vertex->position;
-		const Vector3& b = triangle->edge->next->vertex->position;
-		const Vector3& c = triangle->edge->previous->vertex->position;
+		const Vector3& a = getPosition(i * 3);
+		const Vector3& b = getPosition(i * 3 + 1);
+		const Vector3& c = getPosition(i * 3 + 2);
 		Vector3 ba = b - a;
 		Vector3 ca = c - a;
-		triangle->normal = glm::normalize(glm::cross(ba, ca));
+		triangles[i].normal = glm::normalize(glm::cross(ba, ca));
 	}
 }
 
 } // namespace Emergent
+
@@ -26,26 +26,20 @@ ViewFrustum::ViewFrustum():
 	ConvexHull(6),
 	view(1.0f),
 	projection(1.0f),
-	viewProjection(1.0f)
+	viewProjection(1.0f),
+	cornersDirty(true)
 {
 	recalculatePlanes();
-	recalculateCorners();
 }
 
-ViewFrustum::ViewFrustum(const ViewFrustum& viewFrustum):
-	ConvexHull(6)
-{
-	view = viewFrustum.view;
-	projection = viewFrustum.projection;
-	recalculateFrustum();
-}
-
-ViewFrustum& ViewFrustum::operator=(const ViewFrustum& viewFrustum)
+ViewFrustum::ViewFrustum(const Matrix4& view, const Matrix4& projection):
+	ConvexHull(6),
+	view(view),
+	projection(projection),
+	viewProjection(projection * view),
+	cornersDirty(true)
 {
-	view = viewFrustum.view;
-	projection = viewFrustum.projection;
-	recalculateFrustum();
-	return *this;
+	recalculatePlanes();
 }
 
 void ViewFrustum::setViewMatrix(const Matrix4& view)
@@ -71,7 +65,7 @@ void ViewFrustum::recalculateFrustum()
 {
 	viewProjection = projection * view;
 	recalculatePlanes();
-	recalculateCorners();
+	cornersDirty = true;
 }
 
 void ViewFrustum::recalculatePlanes()
@@ -85,7 +79,7 @@ void ViewFrustum::recalculatePlanes()
 	ConvexHull::setPlane(5, Plane(transpose[3] - transpose[2]));
 }
 
-void ViewFrustum::recalculateCorners()
+void ViewFrustum::recalculateCorners() const
 {
 	corners[0] = Plane::intersection(getNear(), getTop(), getLeft());
 	corners[1] = Plane::intersection(getNear(), getTop(), getRight());
@@ -95,6 +89,7 @@ void ViewFrustum::recalculateCorners()
 	corners[5] = Plane::intersection(getFar(), getTop(), getRight());
 	corners[6] = Plane::intersection(getFar(), getBottom(), getLeft());
 	corners[7] = Plane::intersection(getFar(), getBottom(), getRight());
+	cornersDirty = false;
 }
 
 } // namespace Emergent
@@ -20,6 +20,7 @@
 #include <emergent/graphics/billboard.hpp>
 #include <emergent/graphics/vertex-format.hpp>
 #include <emergent/graphics/camera.hpp>
+#include <emergent/graphics/gl-state.hpp>
 #include <emergent/math/interpolation.hpp>
 #include <emergent/math/math.hpp>
 
@@ -81,9 +82,9 @@ BillboardBatch::~BillboardBatch()
 		delete[] vertexData;
 		vertexData = nullptr;
 		
-		glDeleteBuffers(1, &ibo);
-    	glDeleteBuffers(1, &vbo);
-    	glDeleteVertexArrays(1, &vao);
+		GLState::deleteBuffer(ibo);
+    	GLState::deleteBuffer(vbo);
+    	GLState::deleteVertexArray(vao);
 	}
 }
 
@@ -116,9 +117,9 @@ void BillboardBatch::resize(std::size_t count)
 		delete[] vertexData;
 		vertexData = nullptr;
 		
-		glDeleteBuffers(1, &ibo);
-    	glDeleteBuffers(1, &vbo);
-    	glDeleteVertexArrays(1, &vao);
+		GLState::deleteBuffer(ibo);
+    	GLState::deleteBuffer(vbo);
+    	GLState::deleteVertexArray(vao);
 	}
 	
 	// Allocate billboards
@@ -126,7 +127,7 @@ void BillboardBatch::resize(std::size_t count)
 	
 	// Create VAO
 	glGenVertexArrays(1, &vao);
-	glBindVertexArray(vao);
+	GLState::bindVertexArray(vao);
 	
 	// Generate VBO
 	vertexSize = 3 + 4 + 2;
@@ -136,7 +137,7 @@ void BillboardBatch::resize(std::size_t count)
 	triangleCount = billboards.size() * 2;
 	
 	glGenBuffers(1, &vbo);
-	glBindBuffer(GL_ARRAY_BUFFER, vbo);
+	GLState::bindBuffer(GL_ARRAY_BUFFER, vbo);
 	glBufferData(GL_ARRAY_BUFFER, sizeof(float) * vertexSize * vertexCount, nullptr, GL_DYNAMIC_DRAW);
 	
 	// Setup vertex attribute array
@@ -163,7 +164,7 @@ void BillboardBatch::resize(std::size_t count)
 	}
 	
 	glGenBuffers(1, &ibo);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+	GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
 	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(std::uint32_t) * indexCount, indexData32, GL_STATIC_DRAW);
 	
 	delete[] indexData32;
@@ -276,7 +277,7 @@ void BillboardBatch::batch()
 		*(v++) = coordinatesMin.y;
 	}
 	
-	glBindBuffer(GL_ARRAY_BUFFER, vbo);
+	GLState::bindBuffer(GL_ARRAY_BUFFER, vbo);
 	glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(float) * vertexSize * vertexCount, vertexData);
 }
 
@@ -212,9 +212,7 @@ Matrix4 Camera::interpolateInverseViewProjection(const Matrix4& x, const Matrix4
 ViewFrustum Camera::interpolateViewFrustum(const ViewFrustum& x, const ViewFrustum& y, float a) const
 {
 	// WARNING: Assumes theses tweens have been interpolated beforehand
-	ViewFrustum  frustum;
-	frustum.setMatrices(viewTween.getSubstate(), projectionTween.getSubstate());
-	return frustum;
+	return ViewFrustum(viewTween.getSubstate(), projectionTween.getSubstate());
 }
 
 } // namespace Emergent
@@ -0,0 +1,388 @@
+/*
+ * Copyright (C) 2017-2019  Christopher J. Howard
+ *
+ * This file is part of Emergent.
+ *
+ * Emergent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Emergent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Emergent.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <emergent/graphics/gl-state.hpp>
+#include <algorithm>
+
+namespace Emergent
+{
+
+namespace
+{
+
+/// Value of cached names and enumerations whose state is unknown
+const GLuint unknown = ~0u;
+
+/// Number of texture units whose bindings are cached
+const GLuint textureUnitCount = 32;
+
+/// Number of uniform buffer binding points whose bindings are cached
+const GLuint uniformBufferBindingCount = 16;
+
+/// Capabilities whose states are cached
+const GLenum capabilities[] = {GL_BLEND, GL_CULL_FACE, GL_DEPTH_TEST, GL_SCISSOR_TEST, GL_STENCIL_TEST};
+const std::size_t capabilityCount = sizeof(capabilities) / sizeof(GLenum);
+
+/**
+ * Cached OpenGL state. Booleans are stored as `0` or `1`, or as `unknown`.
+ */
+struct State
+{
+	GLuint program;
+	GLuint vao;
+	GLuint arrayBuffer;
+	GLuint elementArrayBuffer;
+	GLuint uniformBuffer;
+	GLuint uniformBuffers[uniformBufferBindingCount];
+	GLuint drawFramebuffer;
+	GLuint readFramebuffer;
+	GLuint activeTextureUnit;
+	GLuint textures2D[textureUnitCount];
+	GLuint texturesCube[textureUnitCount];
+	GLuint capabilities[capabilityCount];
+	GLuint blendSource;
+	GLuint blendDestination;
+	GLuint depthFunc;
+	GLuint depthMask;
+	GLuint cullFace;
+};
+
+State makeUnknownState()
+{
+	State state;
+	GLuint* begin = reinterpret_cast<GLuint*>(&state);
+	std::fill(begin, begin + sizeof(State) / sizeof(GLuint), unknown);
+	return state;
+}
+
+State state = makeUnknownState();
+GLState::Counters counters = {0, 0};
+
+/**
+ * Updates a cached value.
+ *
+ * @return `true` if the value changed and the state change should be issued, `false` if it is redundant.
+ */
+bool change(GLuint* cached, GLuint value)
+{
+	if (*cached == value)
+	{
+		++counters.skipped;
+		return false;
+	}
+
+	*cached = value;
+	++counters.issued;
+	return true;
+}
+
+/// Returns the cached state of a capability, or `nullptr` if the capability is not cached.
+GLuint* findCapability(GLenum capability)
+{
+	for (std::size_t i = 0; i < capabilityCount; ++i)
+	{
+		if (capabilities[i] == capability)
+		{
+			return &state.capabilities[i];
+		}
+	}
+
+	return nullptr;
+}
+
+/// Returns the cached texture binding of a unit, or `nullptr` if the binding is not cached.
+GLuint* findTexture(GLuint unit, GLenum target)
+{
+	if (unit < textureUnitCount)
+	{
+		if (target == GL_TEXTURE_2D)
+		{
+			return &state.textures2D[unit];
+		}
+		else if (target == GL_TEXTURE_CUBE_MAP)
+		{
+			return &state.texturesCube[unit];
+		}
+	}
+
+	return nullptr;
+}
+
+/// Forgets a cached name which is about to be deleted. Deleting a bound object binds zero in its place.
+void forget(GLuint* cached, GLuint name)
+{
+	if (*cached == name)
+	{
+		*cached = 0;
+	}
+}
+
+} // namespace
+
+void GLState::invalidate()
+{
+	state = makeUnknownState();
+}
+
+void GLState::useProgram(GLuint program)
+{
+	if (change(&state.program, program))
+	{
+		glUseProgram(program);
+	}
+}
+
+void GLState::bindVertexArray(GLuint vao)
+{
+	if (change(&state.vao, vao))
+	{
+		glBindVertexArray(vao);
+
+		// The element array buffer binding is part of the vertex array state
+		state.elementArrayBuffer = unknown;
+	}
+}
+
+void GLState::bindBuffer(GLenum target, GLuint buffer)
+{
+	if (target == GL_ARRAY_BUFFER)
+	{
+		if (change(&state.arrayBuffer, buffer))
+		{
+			glBindBuffer(target, buffer);
+		}
+	}
+	else if (target == GL_ELEMENT_ARRAY_BUFFER)
+	{
+		if (change(&state.elementArrayBuffer, buffer))
+		{
+			glBindBuffer(target, buffer);
+		}
+	}
+	else if (target == GL_UNIFORM_BUFFER)
+	{
+		if (change(&state.uniformBuffer, buffer))
+		{
+			glBindBuffer(target, buffer);
+		}
+	}
+	else
+	{
+		glBindBuffer(target, buffer);
+		++counters.issued;
+	}
+}
+
+void GLState::bindBufferBase(GLenum target, GLuint index, GLuint buffer)
+{
+	if (target == GL_UNIFORM_BUFFER && index < uniformBufferBindingCount)
+	{
+		if (!change(&state.uniformBuffers[index], buffer))
+		{
+			return;
+		}
+	}
+	else
+	{
+		++counters.issued;
+	}
+
+	glBindBufferBase(target, index, buffer);
+
+	// Binding to an indexed binding point also binds to the generic binding point
+	if (target == GL_UNIFORM_BUFFER)
+	{
+		state.uniformBuffer = buffer;
+	}
+}
+
+void GLState::bindTexture(GLuint unit, GLenum target, GLuint texture)
+{
+	GLuint* cached = findTexture(unit, target);
+	if (cached != nullptr && *cached == texture)
+	{
+		++counters.skipped;
+		return;
+	}
+
+	if (change(&state.activeTextureUnit, unit))
+	{
+		glActiveTexture(GL_TEXTURE0 + unit);
+	}
+
+	glBindTexture(target, texture);
+	++counters.issued;
+	if (cached != nullptr)
+	{
+		*cached = texture;
+	}
+}
+
+void GLState::bindFramebuffer(GLenum target, GLuint framebuffer)
+{
+	bool draw = (target == GL_FRAMEBUFFER || target == GL_DRAW_FRAMEBUFFER);
+	bool read = (target == GL_FRAMEBUFFER || target == GL_READ_FRAMEBUFFER);
+	if ((!draw || state.drawFramebuffer == framebuffer) && (!read || state.readFramebuffer == framebuffer))
+	{
+		++counters.skipped;
+		return;
+	}
+
+	glBindFramebuffer(target, framebuffer);
+	++counters.issued;
+	if (draw)
+	{
+		state.drawFramebuffer = framebuffer;
+	}
+	if (read)
+	{
+		state.readFramebuffer = framebuffer;
+	}
+}
+
+void GLState::setEnabled(GLenum capability, bool enabled)
+{
+	GLuint* cached = findCapability(capability);
+	if (cached != nullptr)
+	{
+		if (!change(cached, enabled))
+		{
+			return;
+		}
+	}
+	else
+	{
+		++counters.issued;
+	}
+
+	if (enabled)
+	{
+		glEnable(capability);
+	}
+	else
+	{
+		glDisable(capability);
+	}
+}
+
+void GLState::setBlendFunc(GLenum source, GLenum destination)
+{
+	if (state.blendSource == source && state.blendDestination == destination)
+	{
+		++counters.skipped;
+		return;
+	}
+
+	glBlendFunc(source, destination);
+	++counters.issued;
+	state.blendSource = source;
+	state.blendDestination = destination;
+}
+
+void GLState::setDepthFunc(GLenum function)
+{
+	if (change(&state.depthFunc, function))
+	{
+		glDepthFunc(function);
+	}
+}
+
+void GLState::setDepthMask(bool enabled)
+{
+	if (change(&state.depthMask, enabled))
+	{
+		glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+	}
+}
+
+void GLState::setCullFace(GLenum face)
+{
+	if (change(&state.cullFace, face))
+	{
+		glCullFace(face);
+	}
+}
+
+void GLState::deleteProgram(GLuint program)
+{
+	// A current program is only flagged for deletion, but its state can no longer be relied upon
+	if (state.program == program)
+	{
+		state.program = unknown;
+	}
+
+	glDeleteProgram(program);
+}
+
+void GLState::deleteVertexArray(GLuint vao)
+{
+	if (state.vao == vao)
+	{
+		state.vao = 0;
+		state.elementArrayBuffer = unknown;
+	}
+
+	glDeleteVertexArrays(1, &vao);
+}
+
+void GLState::deleteBuffer(GLuint buffer)
+{
+	forget(&state.arrayBuffer, buffer);
+	forget(&state.elementArrayBuffer, buffer);
+	forget(&state.uniformBuffer, buffer);
+	for (GLuint i = 0; i < uniformBufferBindingCount; ++i)
+	{
+		forget(&state.uniformBuffers[i], buffer);
+	}
+
+	glDeleteBuffers(1, &buffer);
+}
+
+void GLState::deleteTexture(GLuint texture)
+{
+	for (GLuint i = 0; i < textureUnitCount; ++i)
+	{
+		forget(&state.textures2D[i], texture);
+		forget(&state.texturesCube[i], texture);
+	}
+
+	glDeleteTextures(1, &texture);
+}
+
+void GLState::deleteFramebuffer(GLuint framebuffer)
+{
+	forget(&state.drawFramebuffer, framebuffer);
+	forget(&state.readFramebuffer, framebuffer);
+
+	glDeleteFramebuffers(1, &framebuffer);
+}
+
+const GLState::Counters& GLState::getCounters()
+{
+	return counters;
+}
+
+void GLState::resetCounters()
+{
+	counters = {0, 0};
+}
+
+} // namespace Emergent
+
@@ -65,7 +65,16 @@ AABB ModelInstance::calculateBounds() const
 {
 	if (model)
 	{
-		return model->getBounds().transformed(getTransform());
+		const Transform& transform = getTransform();
+		AABB bounds = model->getBounds().transformed(transform);
+		
+		// The model is contained by each of its bounding volumes, so clip the transformed box to the bounds of the others, which do not inflate under rotation
+		AABB obbBounds = model->getOrientedBounds().transformed(transform).getBounds();
+		Sphere sphere = model->getBoundingSphere().transformed(transform);
+		Vector3 minPoint = glm::max(bounds.getMin(), glm::max(obbBounds.getMin(), sphere.getCenter() - sphere.getRadius()));
+		Vector3 maxPoint = glm::min(bounds.getMax(), glm::min(obbBounds.getMax(), sphere.getCenter() + sphere.getRadius()));
+		
+		return AABB(minPoint, maxPoint);
 	}
 	
 	return AABB(getTranslation(), getTranslation());
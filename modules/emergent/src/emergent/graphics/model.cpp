@@ -22,7 +22,12 @@
 #include <emergent/graphics/model-instance.hpp>
 #include <emergent/graphics/vertex-format.hpp>
 #include <emergent/graphics/gl3w.hpp>
+#include <emergent/graphics/gl-state.hpp>
+#include <emergent/geometry/fitting.hpp>
+#include <emergent/geometry/simplification.hpp>
 #include <emergent/geometry/triangle-mesh.hpp>
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <fstream>
 #include <streambuf>
@@ -38,7 +43,10 @@ Model::Model():
 	vao(0),
 	vbo(0),
 	ibo(0),
-	skeleton(nullptr)
+	skeleton(nullptr),
+	bounds(Vector3(0.0f), Vector3(0.0f)),
+	boundingSphere(Vector3(0.0f), 0.0f),
+	orientedBounds(bounds)
 {}
 
 Model::~Model()
@@ -50,9 +58,9 @@ void Model::destroy()
 {
 	if (vao != 0)
 	{
-		glDeleteBuffers(1, &ibo);
-		glDeleteBuffers(1, &vbo);
-		glDeleteVertexArrays(1, &vao);
+		GLState::deleteBuffer(ibo);
+		GLState::deleteBuffer(vbo);
+		GLState::deleteVertexArray(vao);
 		
 		vertexFormat = 0;
 		ibo = 0;
@@ -74,42 +82,106 @@ void Model::destroy()
 	groupMap.clear();
 }
 
-bool Model::create(const TriangleMesh* mesh)
+bool Model::create(const TriangleMesh* mesh, bool smoothNormals, std::size_t levelCount)
 {
 	destroy();
 	
-	std::size_t vertexCount = mesh->getTriangles()->size() * 3;
 	std::size_t vertexSize = 6; // position, normal
-	std::size_t indexCount = mesh->getTriangles()->size() * 3;
 	
-	// Generate vertex and index data from mesh
-	float* vertexData = generateVertexData(mesh);
-	std::uint32_t* indexData = generateIndexData(mesh);
+	// Projected size below which the full-detail geometry is no longer needed
+	const float detailScreenSize = 0.5f;
+	
+	// Create model group
+	Model::Group* group = new Model::Group();
+	group->name = "default";
+	group->material = nullptr;
+	group->indexOffset = 0;
+	group->triangleCount = mesh->getTriangles()->size();
+	
+	// Simplify mesh into levels of detail
+	std::vector<std::vector<std::size_t>> levelIndices;
+	if (levelCount > 0)
+	{
+		simplify(*mesh, levelCount, 0.5f, &levelIndices);
+	}
+	
+	std::vector<Vector3> positions;
+	positions.reserve(mesh->getVertices()->size());
+	for (const TriangleMesh::Vertex& vertex: *mesh->getVertices())
+	{
+		positions.push_back(vertex.position);
+	}
+	
+	// Fit bounding volumes to the mesh vertices
+	if (!positions.empty())
+	{
+		AABB meshBounds(positions.front(), positions.front());
+		for (const Vector3& position: positions)
+		{
+			meshBounds.add(position);
+		}
+		
+		group->bounds = meshBounds;
+		setBounds(meshBounds);
+		setBoundingSphere(fitSphere(positions.size(), positions.data()));
+		setOrientedBounds(fitOBB(positions.size(), positions.data()));
+	}
+	
+	std::vector<float> vertexData;
+	std::vector<std::uint32_t> indexData;
+	std::vector<float> levelVertexData;
+	std::vector<std::uint32_t> levelIndexData;
+	
+	for (std::size_t i = 0; i <= levelIndices.size(); ++i)
+	{
+		// Generate welded vertex and index data from the mesh, followed by each level of detail
+		if (i == 0)
+		{
+			generateVertexData(mesh, smoothNormals, &levelVertexData, &levelIndexData);
+		}
+		else
+		{
+			TriangleMesh levelMesh(positions, levelIndices[i - 1]);
+			generateVertexData(&levelMesh, smoothNormals, &levelVertexData, &levelIndexData);
+		}
+		
+		// Reorder triangles for the post-transform vertex cache, then vertices for fetch locality
+		optimizeVertexCache(&levelIndexData, levelVertexData.size() / vertexSize);
+		optimizeVertexFetch(&levelVertexData, &levelIndexData, vertexSize);
+		
+		// Append the level to the vertex and index data
+		std::uint32_t baseVertex = static_cast<std::uint32_t>(vertexData.size() / vertexSize);
+		std::uint32_t indexOffset = static_cast<std::uint32_t>(indexData.size());
+		vertexData.insert(vertexData.end(), levelVertexData.begin(), levelVertexData.end());
+		for (std::uint32_t index: levelIndexData)
+		{
+			indexData.push_back(baseVertex + index);
+		}
+		
+		// Scale the screen size of each level with the square root of its triangle count, so that triangle counts fall with screen coverage
+		if (i > 0)
+		{
+			Model::LevelOfDetail level;
+			level.indexOffset = indexOffset;
+			level.triangleCount = static_cast<std::uint32_t>(levelIndexData.size() / 3);
+			level.screenSize = detailScreenSize * std::sqrt(static_cast<float>(level.triangleCount) / static_cast<float>(group->triangleCount));
+			group->levels.push_back(level);
+		}
+	}
 	
 	// Create and load VAO, VBO, and IBO
 	glGenVertexArrays(1, &vao);
-	glBindVertexArray(vao);
+	GLState::bindVertexArray(vao);
 	glGenBuffers(1, &vbo);
-	glBindBuffer(GL_ARRAY_BUFFER, vbo);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(float) * vertexSize * vertexCount, vertexData, GL_STATIC_DRAW);
+	GLState::bindBuffer(GL_ARRAY_BUFFER, vbo);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(float) * vertexData.size(), vertexData.data(), GL_STATIC_DRAW);
 	glEnableVertexAttribArray(EMERGENT_VERTEX_POSITION);
 	glVertexAttribPointer(EMERGENT_VERTEX_POSITION, 3, GL_FLOAT, GL_FALSE, vertexSize * sizeof(float), (char*)0 + 0 * sizeof(float));
 	glEnableVertexAttribArray(EMERGENT_VERTEX_NORMAL);
 	glVertexAttribPointer(EMERGENT_VERTEX_NORMAL, 3, GL_FLOAT, GL_FALSE, vertexSize * sizeof(float), (char*)0 + 3 * sizeof(float));
 	glGenBuffers(1, &ibo);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(std::uint32_t) * indexCount, indexData, GL_STATIC_DRAW);
-	
-	// Free vertex and index data
-	delete[] vertexData;
-	delete[] indexData;
-	
-	// Create model group
-	Model::Group* group = new Model::Group();
-	group->name = "default";
-	group->material = nullptr;
-	group->indexOffset = 0;
-	group->triangleCount = mesh->getTriangles()->size();
+	GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(std::uint32_t) * indexData.size(), indexData.data(), GL_STATIC_DRAW);
 	
 	// Add group to the model
 	addGroup(group);
@@ -163,6 +235,20 @@ void Model::setSkeleton(Skeleton* skeleton)
 void Model::setBounds(const AABB& bounds)
 {
 	this->bounds = bounds;
+	
+	Vector3 center = (bounds.getMin() + bounds.getMax()) * 0.5f;
+	boundingSphere = Sphere(center, glm::length(bounds.getMax() - center));
+	orientedBounds = OBB(bounds);
+}
+
+void Model::setBoundingSphere(const Sphere& sphere)
+{
+	boundingSphere = sphere;
+}
+
+void Model::setOrientedBounds(const OBB& bounds)
+{
+	orientedBounds = bounds;
 }
 
 const Model::Group* Model::getGroup(const std::string& name) const
@@ -181,72 +267,305 @@ Model::Group* Model::getGroup(const std::string& name)
 	return it->second;
 }
 
-float* Model::generateVertexData(const TriangleMesh* mesh)
+void Model::generateVertexData(const TriangleMesh* mesh, bool smoothNormals, std::vector<float>* vertexData, std::vector<std::uint32_t>* indexData)
 {
-	float* vertexData = new float[mesh->getTriangles()->size() * 3 * 6];
-	std::size_t offset = 0;
+	const std::vector<TriangleMesh::Edge>& edges = *mesh->getEdges();
+	const std::vector<TriangleMesh::Triangle>& triangles = *mesh->getTriangles();
+	
+	// Each half-edge represents the triangle corner at its starting vertex
+	indexData->assign(edges.size(), TriangleMesh::invalidIndex);
+	vertexData->clear();
+	vertexData->reserve(mesh->getVertices()->size() * 6);
 	
-	for (std::size_t i = 0; i < mesh->getTriangles()->size(); ++i)
+	std::vector<std::uint32_t> corners;
+	std::vector<Vector3> normals;
+	std::vector<std::uint32_t> fanVertices;
+	
+	for (std::uint32_t i = 0; i < edges.size(); ++i)
 	{
-		const TriangleMesh::Triangle* triangle = (*mesh->getTriangles())[i];
+		if ((*indexData)[i] != TriangleMesh::invalidIndex)
+		{
+			continue;
+		}
 		
-		const TriangleMesh::Vertex* a = triangle->edge->vertex;
-		const TriangleMesh::Vertex* b = triangle->edge->next->vertex;
-		const TriangleMesh::Vertex* c = triangle->edge->previous->vertex;
-		const Vector3& normal = triangle->normal;
+		// Gather the fan of corners around the vertex, rotating backward until the fan closes or a boundary is reached
+		corners.clear();
+		std::uint32_t e = i;
+		do
+		{
+			corners.push_back(e);
+			e = edges[TriangleMesh::getPrevious(e)].symmetric;
+		}
+		while (e != i && e != TriangleMesh::invalidIndex);
 		
-		vertexData[offset++] = a->position[0];
-		vertexData[offset++] = a->position[1];
-		vertexData[offset++] = a->position[2];
-		vertexData[offset++] = normal.x;
-		vertexData[offset++] = normal.y;
-		vertexData[offset++] = normal.z;
+		// Rotate forward from the first corner to gather the rest of an open fan
+		if (e == TriangleMesh::invalidIndex)
+		{
+			e = edges[i].symmetric;
+			while (e != TriangleMesh::invalidIndex)
+			{
+				e = TriangleMesh::getNext(e);
+				corners.push_back(e);
+				e = edges[e].symmetric;
+			}
+		}
 		
-		vertexData[offset++] = b->position[0];
-		vertexData[offset++] = b->position[1];
-		vertexData[offset++] = b->position[2];
-		vertexData[offset++] = normal.x;
-		vertexData[offset++] = normal.y;
-		vertexData[offset++] = normal.z;
+		// Determine the normal of each corner
+		normals.clear();
+		if (smoothNormals)
+		{
+			Vector3 normal(0.0f);
+			for (std::uint32_t corner: corners)
+			{
+				normal += triangles[TriangleMesh::getTriangle(corner)].normal;
+			}
+			
+			float length = glm::length(normal);
+			if (length > 0.0f)
+			{
+				normal /= length;
+			}
+			else
+			{
+				normal = triangles[TriangleMesh::getTriangle(i)].normal;
+			}
+			
+			normals.assign(corners.size(), normal);
+		}
+		else
+		{
+			for (std::uint32_t corner: corners)
+			{
+				normals.push_back(triangles[TriangleMesh::getTriangle(corner)].normal);
+			}
+		}
 		
-		vertexData[offset++] = c->position[0];
-		vertexData[offset++] = c->position[1];
-		vertexData[offset++] = c->position[2];
-		vertexData[offset++] = normal.x;
-		vertexData[offset++] = normal.y;
-		vertexData[offset++] = normal.z;
+		// Weld corners with equal normals
+		const Vector3& position = mesh->getPosition(i);
+		fanVertices.clear();
+		for (std::size_t j = 0; j < corners.size(); ++j)
+		{
+			std::uint32_t index = TriangleMesh::invalidIndex;
+			for (std::uint32_t vertex: fanVertices)
+			{
+				const float* normal = &(*vertexData)[vertex * 6 + 3];
+				if (normal[0] == normals[j].x && normal[1] == normals[j].y && normal[2] == normals[j].z)
+				{
+					index = vertex;
+					break;
+				}
+			}
+			
+			if (index == TriangleMesh::invalidIndex)
+			{
+				index = static_cast<std::uint32_t>(vertexData->size() / 6);
+				vertexData->push_back(position.x);
+				vertexData->push_back(position.y);
+				vertexData->push_back(position.z);
+				vertexData->push_back(normals[j].x);
+				vertexData->push_back(normals[j].y);
+				vertexData->push_back(normals[j].z);
+				fanVertices.push_back(index);
+			}
+			
+			(*indexData)[corners[j]] = index;
+		}
+	}
+}
+
+void Model::optimizeVertexCache(std::vector<std::uint32_t>* indexData, std::size_t vertexCount)
+{
+	const int cacheSize = 32;
+	const float cacheDecayPower = 1.5f;
+	const float lastTriangleScore = 0.75f;
+	const float valenceBoostScale = 2.0f;
+	const float valenceBoostPower = 0.5f;
+	
+	std::vector<std::uint32_t>& indices = *indexData;
+	std::size_t triangleCount = indices.size() / 3;
+	if (triangleCount == 0)
+	{
+		return;
+	}
+	
+	// Build vertex-triangle adjacency, bucketed by vertex
+	std::vector<std::uint32_t> remaining(vertexCount, 0);
+	for (std::uint32_t index: indices)
+	{
+		++remaining[index];
+	}
+	
+	std::vector<std::uint32_t> offsets(vertexCount + 1, 0);
+	for (std::size_t i = 0; i < vertexCount; ++i)
+	{
+		offsets[i + 1] = offsets[i] + remaining[i];
+	}
+	
+	std::vector<std::uint32_t> adjacency(indices.size());
+	std::vector<std::uint32_t> fill(offsets.begin(), offsets.end() - 1);
+	for (std::size_t i = 0; i < indices.size(); ++i)
+	{
+		adjacency[fill[indices[i]]++] = static_cast<std::uint32_t>(i / 3);
+	}
+	
+	auto scoreVertex = [&](int cachePosition, std::uint32_t remainingTriangles) -> float
+	{
+		if (remainingTriangles == 0)
+		{
+			return -1.0f;
+		}
 		
-		// Calculate smoothed vertex normal
-		/*
-		Vector3 normal(0.0f);
-		TriangleMesh::Edge* start = vertex->edge;
-		TriangleMesh::Edge* e = start;
-		do
+		float score = 0.0f;
+		if (cachePosition >= 0)
+		{
+			if (cachePosition < 3)
+			{
+				score = lastTriangleScore;
+			}
+			else
+			{
+				float scale = 1.0f / static_cast<float>(cacheSize - 3);
+				score = std::pow(1.0f - static_cast<float>(cachePosition - 3) * scale, cacheDecayPower);
+			}
+		}
+		
+		return score + valenceBoostScale * std::pow(static_cast<float>(remainingTriangles), -valenceBoostPower);
+	};
+	
+	std::vector<float> vertexScores(vertexCount);
+	for (std::size_t i = 0; i < vertexCount; ++i)
+	{
+		vertexScores[i] = scoreVertex(-1, remaining[i]);
+	}
+	
+	std::vector<float> triangleScores(triangleCount);
+	std::vector<bool> emitted(triangleCount, false);
+	for (std::size_t i = 0; i < triangleCount; ++i)
+	{
+		triangleScores[i] = vertexScores[indices[i * 3]] + vertexScores[indices[i * 3 + 1]] + vertexScores[indices[i * 3 + 2]];
+	}
+	
+	// Updates the score of a vertex and the scores of the remaining triangles which use it
+	auto rescoreVertex = [&](std::uint32_t vertex, int cachePosition)
+	{
+		float score = scoreVertex(cachePosition, remaining[vertex]);
+		float delta = score - vertexScores[vertex];
+		vertexScores[vertex] = score;
+		
+		for (std::uint32_t k = 0; k < remaining[vertex]; ++k)
+		{
+			triangleScores[adjacency[offsets[vertex] + k]] += delta;
+		}
+	};
+	
+	std::vector<std::uint32_t> cache;
+	std::vector<std::uint32_t> nextCache;
+	cache.reserve(cacheSize + 3);
+	nextCache.reserve(cacheSize + 3);
+	
+	std::vector<std::uint32_t> result;
+	result.reserve(indices.size());
+	
+	std::size_t cursor = 0;
+	std::uint32_t best = TriangleMesh::invalidIndex;
+	
+	for (std::size_t i = 0; i < triangleCount; ++i)
+	{
+		// If no triangle touches the cache, continue with the next unemitted triangle in input order
+		if (best == TriangleMesh::invalidIndex)
+		{
+			while (emitted[cursor])
+			{
+				++cursor;
+			}
+			best = static_cast<std::uint32_t>(cursor);
+		}
+		
+		// Emit the best triangle
+		emitted[best] = true;
+		const std::uint32_t* triangle = &indices[best * 3];
+		result.insert(result.end(), triangle, triangle + 3);
+		
+		// Push its vertices to the front of the cache and remove it from the adjacency of its vertices
+		nextCache.clear();
+		for (int j = 0; j < 3; ++j)
 		{
-			normal += e->triangle->normal;
-			e = e->previous->symmetric;
+			std::uint32_t vertex = triangle[j];
+			if (std::find(nextCache.begin(), nextCache.end(), vertex) == nextCache.end())
+			{
+				nextCache.push_back(vertex);
+			}
+			
+			std::uint32_t* begin = &adjacency[offsets[vertex]];
+			std::uint32_t* end = begin + remaining[vertex];
+			*std::find(begin, end, best) = *(end - 1);
+			--remaining[vertex];
+		}
+		for (std::uint32_t vertex: cache)
+		{
+			if (vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2])
+			{
+				nextCache.push_back(vertex);
+			}
+		}
+		std::swap(cache, nextCache);
+		
+		// Vertices which fall out of the cache lose their cache score
+		for (std::size_t j = cacheSize; j < cache.size(); ++j)
+		{
+			rescoreVertex(cache[j], -1);
+		}
+		if (cache.size() > static_cast<std::size_t>(cacheSize))
+		{
+			cache.resize(cacheSize);
+		}
+		
+		// Rescore the vertices in the cache and the triangles which use them, and select the next best triangle
+		for (std::size_t j = 0; j < cache.size(); ++j)
+		{
+			rescoreVertex(cache[j], static_cast<int>(j));
+		}
+		
+		best = TriangleMesh::invalidIndex;
+		float bestScore = -1.0f;
+		for (std::uint32_t vertex: cache)
+		{
+			for (std::uint32_t k = 0; k < remaining[vertex]; ++k)
+			{
+				std::uint32_t candidate = adjacency[offsets[vertex] + k];
+				if (triangleScores[candidate] > bestScore)
+				{
+					bestScore = triangleScores[candidate];
+					best = candidate;
+				}
+			}
 		}
-		while (e != start && e != nullptr);
-		normal = glm::normalize(normal);
-		*/
 	}
 	
-	return vertexData;
+	indices.swap(result);
 }
 
-std::uint32_t* Model::generateIndexData(const TriangleMesh* mesh)
+void Model::optimizeVertexFetch(std::vector<float>* vertexData, std::vector<std::uint32_t>* indexData, std::size_t vertexSize)
 {
-	std::uint32_t* indexData = new std::uint32_t[mesh->getTriangles()->size() * 3];
-	std::size_t offset = 0;
+	std::size_t vertexCount = vertexData->size() / vertexSize;
+	std::vector<std::uint32_t> remap(vertexCount, TriangleMesh::invalidIndex);
+	std::vector<float> result;
+	result.reserve(vertexData->size());
 	
-	for (std::size_t i = 0; i < mesh->getTriangles()->size(); ++i)
+	std::uint32_t nextVertex = 0;
+	for (std::uint32_t& index: *indexData)
 	{
-		indexData[offset++] = i * 3;
-		indexData[offset++] = i * 3 + 1;
-		indexData[offset++] = i * 3 + 2;
+		if (remap[index] == TriangleMesh::invalidIndex)
+		{
+			const float* vertex = &(*vertexData)[index * vertexSize];
+			result.insert(result.end(), vertex, vertex + vertexSize);
+			remap[index] = nextVertex++;
+		}
+		
+		index = remap[index];
 	}
 	
-	return indexData;
+	vertexData->swap(result);
 }
 
 } // namespace Emergent
@@ -25,12 +25,45 @@
 #include <emergent/graphics/model-instance.hpp>
 #include <emergent/graphics/light.hpp>
 #include <emergent/graphics/billboard.hpp>
+#include <emergent/graphics/gl-state.hpp>
 #include <emergent/graphics/vertex-format.hpp>
+#include <emergent/geometry/culling.hpp>
+#include <algorithm>
+#include <cstring>
 #include <iostream>
+#include <limits>
 
 namespace Emergent
 {
 
+std::uint64_t makeRenderKey(std::uint32_t layer, std::uint32_t permutation, const Material* material, GLuint vao, float depth, bool backToFront)
+{
+	// Hash the material address, as materials have no compact identifiers
+	std::uint64_t materialHash = static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(material)) * 0x9E3779B97F4A7C15ull >> 48;
+
+	// The bits of a non-negative float increase with its value, so the exponent and leading mantissa bits form a logarithmic quantization
+	std::uint32_t depthBits = 0;
+	if (depth > 0.0f)
+	{
+		std::memcpy(&depthBits, &depth, sizeof(float));
+	}
+	std::uint64_t quantizedDepth = (depthBits >> 15) & 0xFFFF;
+	if (backToFront)
+	{
+		quantizedDepth ^= 0xFFFF;
+	}
+
+	return (static_cast<std::uint64_t>(layer & 0xF) << 60)
+		| (static_cast<std::uint64_t>(permutation & 0xFFF) << 48)
+		| (materialHash << 32)
+		| (static_cast<std::uint64_t>(vao & 0xFFFF) << 16)
+		| quantizedDepth;
+}
+
+RenderQueue::RenderQueue():
+	camera(nullptr)
+{}
+
 void RenderQueue::queue(const SceneObject* object)
 {
 	if (object->isActive())
@@ -59,6 +92,11 @@ void RenderQueue::queue(const ModelInstance* instance)
 	const Model* model = instance->getModel();
 	operation.vao = model->getVAO();
 	operation.pose = instance->getPose();
+	operation.instanceOffset = 0;
+	operation.instanceCount = 1;
+	
+	// Calculate projected size, for selecting levels of detail
+	float screenSize = calculateScreenSize(instance);
 	
 	for (std::size_t i = 0; i < model->getGroupCount(); ++i)
 	{
@@ -67,6 +105,18 @@ void RenderQueue::queue(const ModelInstance* instance)
 		
 		operation.indexOffset = group->indexOffset;
 		operation.triangleCount = group->triangleCount;
+		
+		// Select the least detailed level which is still larger than the projected size
+		for (const Model::LevelOfDetail& level: group->levels)
+		{
+			if (screenSize >= level.screenSize)
+			{
+				break;
+			}
+			
+			operation.indexOffset = level.indexOffset;
+			operation.triangleCount = level.triangleCount;
+		}
 
 		if (instance->getMaterialSlot(i) != nullptr)
 		{
@@ -90,6 +140,8 @@ void RenderQueue::queue(const BillboardBatch* batch)
 	operation.transform = batch->getTransformMatrixTween()->getSubstate();
 	operation.vao = batch->vao;
 	operation.pose = nullptr;
+	operation.instanceOffset = 0;
+	operation.instanceCount = 1;
 	
 	for (std::size_t i = 0; i < batch->getRangeCount(); ++i)
 	{
@@ -107,9 +159,191 @@ void RenderQueue::queue(const RenderOperation& operation)
 	operations.push_back(operation);
 }
 
+void RenderQueue::sort()
+{
+	std::size_t count = operations.size();
+	sortEntries.resize(count);
+	sortBuffer.resize(count);
+
+	// Count the occurrences of each byte of the keys
+	std::size_t histograms[8][256] = {};
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		std::uint64_t key = operations[i].key;
+		sortEntries[i] = {key, static_cast<std::uint32_t>(i)};
+		for (std::size_t j = 0; j < 8; ++j)
+		{
+			++histograms[j][(key >> (j * 8)) & 0xFF];
+		}
+	}
+
+	// Sort by each byte from least to most significant, skipping bytes which are equal in all keys
+	SortEntry* source = sortEntries.data();
+	SortEntry* destination = sortBuffer.data();
+	for (std::size_t j = 0; j < 8 && count; ++j)
+	{
+		std::size_t* histogram = histograms[j];
+		if (histogram[(source[0].key >> (j * 8)) & 0xFF] == count)
+		{
+			continue;
+		}
+
+		std::size_t offset = 0;
+		for (std::size_t k = 0; k < 256; ++k)
+		{
+			std::size_t bucketCount = histogram[k];
+			histogram[k] = offset;
+			offset += bucketCount;
+		}
+
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			destination[histogram[(source[i].key >> (j * 8)) & 0xFF]++] = source[i];
+		}
+
+		std::swap(source, destination);
+	}
+
+	// Move the operations into sorted order
+	sortedOperations.resize(count);
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		sortedOperations[i] = operations[source[i].index];
+	}
+	operations.swap(sortedOperations);
+}
+
+void RenderQueue::instance()
+{
+	// Maximum number of batches searched for each operation, which bounds the cost of ranges that draw many different pieces of geometry
+	const std::size_t maxSearchedBatches = 16;
+	
+	std::size_t count = operations.size();
+	std::size_t instancedCount = 0;
+	instanceTransforms.resize(count);
+	
+	for (std::size_t begin = 0; begin < count;)
+	{
+		// Find the range of operations whose keys share layer, permutation, material, and vertex array
+		std::uint64_t state = operations[begin].key >> 16;
+		std::size_t end = begin + 1;
+		while (end < count && (operations[end].key >> 16) == state)
+		{
+			++end;
+		}
+		
+		// Assign each operation in the range to a batch, and count the operations of each batch
+		batchFirsts.clear();
+		batchOffsets.clear();
+		batchIndices.resize(end - begin);
+		for (std::size_t i = begin; i < end; ++i)
+		{
+			std::size_t batch = batchFirsts.size();
+			for (std::size_t j = (batch > maxSearchedBatches) ? batch - maxSearchedBatches : 0; j < batchFirsts.size(); ++j)
+			{
+				if (isInstanceOf(operations[batchFirsts[j]], operations[i]))
+				{
+					batch = j;
+					break;
+				}
+			}
+			
+			if (batch == batchFirsts.size())
+			{
+				batchFirsts.push_back(i);
+				batchOffsets.push_back(0);
+			}
+			
+			++batchOffsets[batch];
+			batchIndices[i - begin] = batch;
+		}
+		
+		// Give each batch a contiguous range of instance transforms
+		std::size_t offset = begin;
+		for (std::size_t& batchOffset: batchOffsets)
+		{
+			std::size_t batchCount = batchOffset;
+			batchOffset = offset;
+			offset += batchCount;
+		}
+		
+		for (std::size_t i = begin; i < end; ++i)
+		{
+			instanceTransforms[batchOffsets[batchIndices[i - begin]]++] = operations[i].transform;
+		}
+		
+		// Replace the operations of the range with the first operation of each batch. Batches are never ahead of their first operations, so no unread operation is overwritten.
+		for (std::size_t j = 0; j < batchFirsts.size(); ++j)
+		{
+			RenderOperation operation = operations[batchFirsts[j]];
+			operation.instanceOffset = (j > 0) ? batchOffsets[j - 1] : begin;
+			operation.instanceCount = batchOffsets[j] - operation.instanceOffset;
+			operations[instancedCount++] = operation;
+		}
+		
+		begin = end;
+	}
+	
+	operations.resize(instancedCount);
+}
+
 void RenderQueue::clear()
 {
 	operations.clear();
+	instanceTransforms.clear();
+}
+
+bool RenderQueue::isInstanceOf(const RenderOperation& lhs, const RenderOperation& rhs)
+{
+	return (lhs.vao == rhs.vao
+		&& lhs.indexOffset == rhs.indexOffset
+		&& lhs.triangleCount == rhs.triangleCount
+		&& lhs.material == rhs.material
+		&& lhs.pose == rhs.pose);
+}
+
+float RenderQueue::calculateScreenSize(const SceneObject* object) const
+{
+	if (camera == nullptr)
+	{
+		return std::numeric_limits<float>::infinity();
+	}
+	
+	// Find the bounding sphere of the object bounds
+	const AABB& bounds = object->getBoundsTween()->getSubstate();
+	Vector3 center = (bounds.getMin() + bounds.getMax()) * 0.5f;
+	float radius = glm::length(bounds.getMax() - bounds.getMin()) * 0.5f;
+	
+	const Matrix4& projection = camera->getProjectionTween()->getSubstate();
+	
+	// Orthographic projections are independent of distance
+	if (projection[3][3] != 0.0f)
+	{
+		return radius * projection[1][1];
+	}
+	
+	const Matrix4& view = camera->getViewTween()->getSubstate();
+	float distance = -(view * Vector4(center, 1.0f)).z;
+	if (distance <= radius)
+	{
+		return std::numeric_limits<float>::infinity();
+	}
+	
+	return radius * projection[1][1] / distance;
+}
+
+void bindInstanceTransforms(GLuint instanceBuffer, std::size_t instanceOffset)
+{
+	GLState::bindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+	
+	// Feed one matrix column to each attribute location, advancing once per instance
+	for (GLuint column = 0; column < 4; ++column)
+	{
+		GLuint location = EMERGENT_VERTEX_INSTANCE_TRANSFORM + column;
+		glEnableVertexAttribArray(location);
+		glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, sizeof(Matrix4), (char*)0 + instanceOffset * sizeof(Matrix4) + column * sizeof(Vector4));
+		glVertexAttribDivisor(location, 1);
+	}
 }
 
 RenderPass::RenderPass():
@@ -158,11 +392,22 @@ void Compositor::render(RenderContext* renderContext)
 	}
 }
 
-Renderer::Renderer()
+Renderer::Renderer():
+	occlusionCullingEnabled(true),
+	occlusionBuffer(256, 128),
+	cameraUniformBuffer(CameraBlock::bindingPoint),
+	lightUniformBuffer(LightBlock::bindingPoint),
+	instancingEnabled(false),
+	instanceBuffer(0)
 {}
 
 Renderer::~Renderer()
-{}
+{
+	if (instanceBuffer != 0)
+	{
+		GLState::deleteBuffer(instanceBuffer);
+	}
+}
 
 void Renderer::render(const Scene& scene)
 {
@@ -190,9 +435,15 @@ void Renderer::render(const Scene& scene)
 			return lhs->getCompositeIndex() < rhs->getCompositeIndex();
 		});
 	
+	// Upload the lighting state, which is shared by all cameras
+	updateLightBlock(scene);
+	
 	// For each active camera
 	for (Camera* camera: cameras)
 	{
+		// Upload the camera matrices before the camera's render passes run
+		updateCameraBlock(*camera);
+		
 		const ViewFrustum& viewFrustum = camera->getViewFrustumTween()->getSubstate();
 
 		const std::list<SceneObject*>* objects = scene.getObjects();
@@ -201,43 +452,166 @@ void Renderer::render(const Scene& scene)
 			continue;
 		}
 		
-		// Add visible objects to render queue
+		// Cull the bounds of unmasked objects against the view frustum in a single batch
+		bool batchCulling = camera->isCullingEnabled() && !camera->getCullingMask();
+		if (batchCulling)
+		{
+			std::size_t count = 0;
+			for (const SceneObject* object: *objects)
+			{
+				if (object->isCullingEnabled() && !object->getCullingMask())
+				{
+					++count;
+				}
+			}
+
+			cullingBounds.resize(count * 6);
+			cullingVisibility.resize((count + 31) / 32);
+			float* minX = cullingBounds.data();
+			float* minY = minX + count;
+			float* minZ = minY + count;
+			float* maxX = minZ + count;
+			float* maxY = maxX + count;
+			float* maxZ = maxY + count;
+
+			std::size_t i = 0;
+			for (const SceneObject* object: *objects)
+			{
+				if (object->isCullingEnabled() && !object->getCullingMask())
+				{
+					const AABB& bounds = object->getBoundsTween()->getSubstate();
+					minX[i] = bounds.getMin().x;
+					minY[i] = bounds.getMin().y;
+					minZ[i] = bounds.getMin().z;
+					maxX[i] = bounds.getMax().x;
+					maxY[i] = bounds.getMax().y;
+					maxZ[i] = bounds.getMax().z;
+					++i;
+				}
+			}
+
+			cullAABBs(viewFrustum, count, minX, minY, minZ, maxX, maxY, maxZ, cullingVisibility.data());
+		}
+		
+		// Gather objects which pass frustum culling
+		renderQueue.setCamera(camera);
+		std::size_t cullingIndex = 0;
 		for (SceneObject* object: *objects)
 		{
 			if (camera->isCullingEnabled() && object->isCullingEnabled())
 			{
-				const BoundingVolume* cameraCullingVolume = &viewFrustum;
-				const BoundingVolume* objectCullingVolume = &object->getBoundsTween()->getSubstate();
-				if (camera->getCullingMask())
+				if (batchCulling && !object->getCullingMask())
 				{
-					cameraCullingVolume = camera->getCullingMask();
+					std::size_t i = cullingIndex++;
+					if (!((cullingVisibility[i / 32] >> (i % 32)) & 1))
+					{
+						continue;
+					}
 				}
+				else
+				{
+					const BoundingVolume* cameraCullingVolume = &viewFrustum;
+					const BoundingVolume* objectCullingVolume = &object->getBoundsTween()->getSubstate();
+					if (camera->getCullingMask())
+					{
+						cameraCullingVolume = camera->getCullingMask();
+					}
+
+					if (object->getCullingMask())
+					{
+						objectCullingVolume = object->getCullingMask();
+					}
 
-				if (object->getCullingMask())
+					// Cull objects outside culling volume
+					if (!cameraCullingVolume->intersects(*objectCullingVolume))
+					{
+						continue;
+					}
+				}
+				
+				// Boxes of rotated models are loose, so also test the tighter model volumes of models which passed
+				if (!object->getCullingMask() && object->getSceneObjectType() == SceneObjectType::MODEL_INSTANCE)
 				{
-					objectCullingVolume = object->getCullingMask();
+					const Model* model = static_cast<const ModelInstance*>(object)->getModel();
+					if (model != nullptr)
+					{
+						const BoundingVolume* cameraCullingVolume = (camera->getCullingMask()) ? camera->getCullingMask() : &viewFrustum;
+						const Transform& transform = object->getTransformTween()->getSubstate();
+						if (!cameraCullingVolume->intersects(model->getBoundingSphere().transformed(transform)) || !cameraCullingVolume->intersects(model->getOrientedBounds().transformed(transform)))
+						{
+							continue;
+						}
+					}
 				}
+			}
+			
+			visibleObjects.push_back(object);
+		}
 
-				// Cull objects outside culling volume
-				if (!cameraCullingVolume->intersects(*objectCullingVolume))
+		// Cull objects hidden behind the occluders of visible objects
+		if (occlusionCullingEnabled && camera->isCullingEnabled() && !camera->getCullingMask())
+		{
+			// Clear the buffer only once the first occluder is found, so scenes without occluders cost nothing
+			bool occluders = false;
+			for (const SceneObject* object: visibleObjects)
+			{
+				if (object->isActive() && object->getOccluder() != nullptr)
 				{
-					continue;
+					if (!occluders)
+					{
+						occlusionBuffer.clear(viewFrustum.getViewProjectionMatrix());
+					}
+
+					occlusionBuffer.rasterize(object->getTransformMatrixTween()->getSubstate(), *object->getOccluder());
+					occluders = true;
 				}
 			}
-			
+
+			if (occluders)
+			{
+				visibleObjects.erase(std::remove_if(visibleObjects.begin(), visibleObjects.end(),
+					[this](const SceneObject* object)
+					{
+						return object->isCullingEnabled() && !object->getCullingMask() && !occlusionBuffer.isVisible(object->getBoundsTween()->getSubstate());
+					}), visibleObjects.end());
+			}
+		}
+
+		// Add visible objects to render queue
+		for (SceneObject* object: visibleObjects)
+		{
 			renderQueue.queue(object);
 		}
+		visibleObjects.clear();
 		
-		// Calculate depths (distance to near clipping plane)
+		// Calculate depths (distance to near clipping plane) and sort operations by state, then front to back
 		for (RenderOperation& op: *renderQueue.getOperations())
 		{
 			op.depth = viewFrustum.getNear().distance(Vector3(op.transform[3]));
+			op.key = makeRenderKey(0, 0, op.material, op.vao, op.depth);
+		}
+		renderQueue.sort();
+		
+		// Merge operations into instanced operations, and stream their transforms into the instance buffer
+		if (instancingEnabled)
+		{
+			renderQueue.instance();
+			
+			if (instanceBuffer == 0)
+			{
+				glGenBuffers(1, &instanceBuffer);
+			}
+			
+			const std::vector<Matrix4>* instanceTransforms = renderQueue.getInstanceTransforms();
+			GLState::bindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+			glBufferData(GL_ARRAY_BUFFER, instanceTransforms->size() * sizeof(Matrix4), instanceTransforms->data(), GL_STREAM_DRAW);
 		}
 		
 		// Form render context
 		renderContext.camera = camera;
 		renderContext.scene = &scene;
 		renderContext.queue = &renderQueue;
+		renderContext.instanceBuffer = (instancingEnabled) ? instanceBuffer : 0;
 		
 		// Pass render context to the camera's compositor and render it
 		camera->getCompositor()->render(&renderContext);
@@ -247,4 +621,72 @@ void Renderer::render(const Scene& scene)
 	}
 }
 
+void Renderer::updateLightBlock(const Scene& scene)
+{
+	std::size_t pointLightCount = 0;
+	std::size_t directionalLightCount = 0;
+	std::size_t spotlightCount = 0;
+	
+	const std::list<SceneObject*>* lights = scene.getObjects(SceneObjectType::LIGHT);
+	if (lights != nullptr)
+	{
+		for (const SceneObject* object: *lights)
+		{
+			if (!object->isActive())
+			{
+				continue;
+			}
+			
+			const Light* light = static_cast<const Light*>(object);
+			const Vector3& position = light->getTransformTween()->getSubstate().translation;
+			
+			if (light->getLightType() == LightType::POINT && pointLightCount < LightBlock::maxPointLights)
+			{
+				const PointLight* pointLight = static_cast<const PointLight*>(light);
+				std::size_t i = pointLightCount++;
+				lightBlock.pointLightPositions[i] = Vector4(position, 1.0f);
+				lightBlock.pointLightColors[i] = Vector4(pointLight->getColorTween()->getSubstate() * pointLight->getIntensityTween()->getSubstate(), 1.0f);
+				lightBlock.pointLightAttenuations[i] = Vector4(pointLight->getAttenuationTween()->getSubstate(), 0.0f);
+			}
+			else if (light->getLightType() == LightType::DIRECTIONAL && directionalLightCount < LightBlock::maxDirectionalLights)
+			{
+				const DirectionalLight* directionalLight = static_cast<const DirectionalLight*>(light);
+				std::size_t i = directionalLightCount++;
+				lightBlock.directionalLightDirections[i] = Vector4(directionalLight->getDirectionTween()->getSubstate(), 0.0f);
+				lightBlock.directionalLightColors[i] = Vector4(directionalLight->getColorTween()->getSubstate() * directionalLight->getIntensityTween()->getSubstate(), 1.0f);
+			}
+			else if (light->getLightType() == LightType::SPOTLIGHT && spotlightCount < LightBlock::maxSpotlights)
+			{
+				const Spotlight* spotlight = static_cast<const Spotlight*>(light);
+				std::size_t i = spotlightCount++;
+				lightBlock.spotlightPositions[i] = Vector4(position, 1.0f);
+				lightBlock.spotlightColors[i] = Vector4(spotlight->getColorTween()->getSubstate() * spotlight->getIntensityTween()->getSubstate(), 1.0f);
+				lightBlock.spotlightAttenuations[i] = Vector4(spotlight->getAttenuationTween()->getSubstate(), spotlight->getExponentTween()->getSubstate());
+				lightBlock.spotlightDirections[i] = Vector4(spotlight->getDirectionTween()->getSubstate(), spotlight->getCutoffTween()->getSubstate());
+			}
+		}
+	}
+	
+	lightBlock.counts[0] = static_cast<std::int32_t>(pointLightCount);
+	lightBlock.counts[1] = static_cast<std::int32_t>(directionalLightCount);
+	lightBlock.counts[2] = static_cast<std::int32_t>(spotlightCount);
+	lightBlock.counts[3] = 0;
+	
+	lightUniformBuffer.update(&lightBlock, sizeof(LightBlock));
+}
+
+void Renderer::updateCameraBlock(const Camera& camera)
+{
+	cameraBlock.view = camera.getViewTween()->getSubstate();
+	cameraBlock.projection = camera.getProjectionTween()->getSubstate();
+	cameraBlock.viewProjection = camera.getViewProjectionTween()->getSubstate();
+	cameraBlock.inverseView = glm::inverse(cameraBlock.view);
+	cameraBlock.inverseProjection = camera.getInverseProjectionTween()->getSubstate();
+	cameraBlock.inverseViewProjection = camera.getInverseViewProjectionTween()->getSubstate();
+	cameraBlock.position = cameraBlock.inverseView[3];
+	cameraBlock.clip = Vector4(camera.getClipNearTween()->getSubstate(), camera.getClipFarTween()->getSubstate(), 0.0f, 0.0f);
+	
+	cameraUniformBuffer.update(&cameraBlock, sizeof(CameraBlock));
+}
+
 } // namespace Emergent
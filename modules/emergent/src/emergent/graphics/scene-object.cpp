@@ -28,6 +28,7 @@ SceneObject::SceneObject():
 	active(true),
 	cullingEnabled(true),
 	cullingMask(nullptr),
+	occluder(nullptr),
 	bounds(transform.translation, transform.translation),
 	transform(Transform::getIdentity()),
 	forward(0, 0, -1),
@@ -18,6 +18,7 @@
  */
 
 #include <emergent/graphics/shader-input.hpp>
+#include <emergent/graphics/gl-state.hpp>
 #include <emergent/graphics/texture-2d.hpp>
 #include <emergent/graphics/texture-cube.hpp>
 
@@ -31,7 +32,8 @@ ShaderInput::ShaderInput(Shader* shader, std::size_t inputIndex, GLint uniformLo
 	name(name),
 	dataType(dataType),
 	elementCount(elementCount),
-	textureUnit(textureUnit)
+	textureUnit(textureUnit),
+	uploadedVersion(nullptr)
 {}
 
 ShaderInput::~ShaderInput()
@@ -42,6 +44,8 @@ bool ShaderInput::upload(const int& value) const
 	if (uniformLocation == -1)
 		return false;
 	
+	forgetUploadedVersion();
+	
 	glUniform1i(uniformLocation, value);
 	return true;
 }
@@ -51,6 +55,8 @@ bool ShaderInput::upload(const float& value) const
 	if (uniformLocation == -1)
 		return false;
 	
+	forgetUploadedVersion();
+	
 	glUniform1f(uniformLocation, value);
 	return true;
 }
@@ -60,6 +66,8 @@ bool ShaderInput::upload(const Vector2& value) const
 	if (uniformLocation == -1)
 		return false;
 	
+	forgetUploadedVersion();
+	
 	glUniform2fv(uniformLocation, 1, glm::value_ptr(value));
 	return true;
 }
@@ -69,6 +77,8 @@ bool ShaderInput::upload(const Vector3& value) const
 	if (uniformLocation == -1)
 		return false;
 	
+	forgetUploadedVersion();
+	
 	glUniform3fv(uniformLocation, 1, glm::value_ptr(value));
 	return true;
 }
@@ -78,6 +88,8 @@ bool ShaderInput::upload(const Vector4& value) const
 	if (uniformLocation == -1)
 		return false;
 	
+	forgetUploadedVersion();
+	
 	glUniform4fv(uniformLocation, 1, glm::value_ptr(value));
 	return true;
 }
@@ -87,6 +99,8 @@ bool ShaderInput::upload(const Matrix3& value) const
 	if (uniformLocation == -1)
 		return false;
 	
+	forgetUploadedVersion();
+	
 	glUniformMatrix3fv(uniformLocation, 1, GL_FALSE, glm::value_ptr(value));
 	return true;
 }
@@ -96,6 +110,8 @@ bool ShaderInput::upload(const Matrix4& value) const
 	if (uniformLocation == -1)
 		return false;
 	
+	forgetUploadedVersion();
+	
 	glUniformMatrix4fv(uniformLocation, 1, GL_FALSE, glm::value_ptr(value));
 	return true;
 }
@@ -106,11 +122,17 @@ bool ShaderInput::upload(const Texture2D* value) const
 		return false;
 	
 	// Bind texture to a texture unit reserved by this shader input
-	glActiveTexture(GL_TEXTURE0 + textureUnit);
-	glBindTexture(GL_TEXTURE_2D, value->getTextureID());
+	GLState::bindTexture(textureUnit, GL_TEXTURE_2D, value->getTextureID());
 	
-	// Upload texture unit index to shader
-	glUniform1i(uniformLocation, textureUnit);
+	// Upload texture unit index to shader, unless the active permutation already samples from it
+	if (uploadedVersion == nullptr || *uploadedVersion != samplerVersion)
+	{
+		glUniform1i(uniformLocation, textureUnit);
+		if (uploadedVersion != nullptr)
+		{
+			*uploadedVersion = samplerVersion;
+		}
+	}
 	
 	return true;
 }
@@ -121,11 +143,17 @@ bool ShaderInput::upload(const TextureCube* value) const
 		return false;
 	
 	// Bind texture to a texture unit reserved by this shader input
-	glActiveTexture(GL_TEXTURE0 + textureUnit);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, value->getTextureID());
+	GLState::bindTexture(textureUnit, GL_TEXTURE_CUBE_MAP, value->getTextureID());
 	
-	// Upload texture unit index to shader
-	glUniform1i(uniformLocation, textureUnit);
+	// Upload texture unit index to shader, unless the active permutation already samples from it
+	if (uploadedVersion == nullptr || *uploadedVersion != samplerVersion)
+	{
+		glUniform1i(uniformLocation, textureUnit);
+		if (uploadedVersion != nullptr)
+		{
+			*uploadedVersion = samplerVersion;
+		}
+	}
 	
 	return true;
 }
@@ -135,6 +163,8 @@ bool ShaderInput::upload(std::size_t index, const int& value) const
 	if (uniformLocation == -1)
 		return false;
 	
+	forgetUploadedVersion();
+	
 	glUniform1i(uniformLocation + index, value);
 	return true;
 }
@@ -144,6 +174,8 @@ bool ShaderInput::upload(std::size_t index, const float& value) const
 	if (uniformLocation == -1)
 		return false;
 	
+	forgetUploadedVersion();
+	
 	glUniform1f(uniformLocation + index, value);
 	return true;
 }
@@ -153,6 +185,8 @@ bool ShaderInput::upload(std::size_t index, const Vector2& value) const
 	if (uniformLocation == -1)
 		return false;
 	
+	forgetUploadedVersion();
+	
 	glUniform2fv(uniformLocation + index, 1, glm::value_ptr(value));
 	return true;
 }
@@ -162,6 +196,8 @@ bool ShaderInput::upload(std::size_t index, const Vector3& value) const
 	if (uniformLocation == -1)
 		return false;
 	
+	forgetUploadedVersion();
+	
 	glUniform3fv(uniformLocation + index, 1, glm::value_ptr(value));
 	return true;
 }
@@ -171,6 +207,8 @@ bool ShaderInput::upload(std::size_t index, const Vector4& value) const
 	if (uniformLocation == -1)
 		return false;
 	
+	forgetUploadedVersion();
+	
 	glUniform4fv(uniformLocation + index, 1, glm::value_ptr(value));
 	return true;
 }
@@ -180,6 +218,8 @@ bool ShaderInput::upload(std::size_t index, const Matrix3& value) const
 	if (uniformLocation == -1)
 		return false;
 	
+	forgetUploadedVersion();
+	
 	glUniformMatrix3fv(uniformLocation + index * 3, 1, GL_FALSE, glm::value_ptr(value));
 	return true;
 }
@@ -189,6 +229,8 @@ bool ShaderInput::upload(std::size_t index, const Matrix4& value) const
 	if (uniformLocation == -1)
 		return false;
 	
+	forgetUploadedVersion();
+	
 	glUniformMatrix4fv(uniformLocation + index * 4, 1, GL_FALSE, glm::value_ptr(value));
 	return true;
 }
@@ -199,8 +241,7 @@ bool ShaderInput::upload(std::size_t index, const Texture2D* value) const
 		return false;
 	
 	// Bind texture to a texture unit reserved by this shader input
-	glActiveTexture(GL_TEXTURE0 + textureUnit + index);
-	glBindTexture(GL_TEXTURE_2D, value->getTextureID());
+	GLState::bindTexture(textureUnit + index, GL_TEXTURE_2D, value->getTextureID());
 	
 	// Upload texture unit index to shader
 	glUniform1i(uniformLocation + index, textureUnit + index);
@@ -214,8 +255,7 @@ bool ShaderInput::upload(std::size_t index, const TextureCube* value) const
 		return false;
 	
 	// Bind texture to a texture unit reserved by this shader input
-	glActiveTexture(GL_TEXTURE0 + textureUnit + index);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, value->getTextureID());
+	GLState::bindTexture(textureUnit + index, GL_TEXTURE_CUBE_MAP, value->getTextureID());
 	
 	// Upload texture unit index to shader
 	glUniform1i(uniformLocation + index, textureUnit + index);
@@ -228,6 +268,8 @@ bool ShaderInput::upload(std::size_t index, const int* values, std::size_t count
 	if (uniformLocation == -1)
 		return false;
 	
+	forgetUploadedVersion();
+	
 	glUniform1iv(uniformLocation + index, static_cast<GLsizei>(count), &values[0]);
 	return true;
 }
@@ -237,6 +279,8 @@ bool ShaderInput::upload(std::size_t index, const float* values, std::size_t cou
 	if (uniformLocation == -1)
 		return false;
 	
+	forgetUploadedVersion();
+	
 	glUniform1fv(uniformLocation + index, static_cast<GLsizei>(count), &values[0]);
 	return true;
 }
@@ -246,6 +290,8 @@ bool ShaderInput::upload(std::size_t index, const Vector2* values, std::size_t c
 	if (uniformLocation == -1)
 		return false;
 	
+	forgetUploadedVersion();
+	
 	glUniform2fv(uniformLocation + index, static_cast<GLsizei>(count), glm::value_ptr(values[0]));
 	return true;
 }
@@ -255,6 +301,8 @@ bool ShaderInput::upload(std::size_t index, const Vector3* values, std::size_t c
 	if (uniformLocation == -1)
 		return false;
 	
+	forgetUploadedVersion();
+	
 	glUniform3fv(uniformLocation + index, static_cast<GLsizei>(count), glm::value_ptr(values[0]));
 	return true;
 }
@@ -264,6 +312,8 @@ bool ShaderInput::upload(std::size_t index, const Vector4* values, std::size_t c
 	if (uniformLocation == -1)
 		return false;
 	
+	forgetUploadedVersion();
+	
 	glUniform4fv(uniformLocation + index, static_cast<GLsizei>(count), glm::value_ptr(values[0]));
 	return true;
 }
@@ -273,6 +323,8 @@ bool ShaderInput::upload(std::size_t index, const Matrix3* values, std::size_t c
 	if (uniformLocation == -1)
 		return false;
 	
+	forgetUploadedVersion();
+	
 	glUniformMatrix3fv(uniformLocation + index * 3, static_cast<GLsizei>(count), GL_FALSE, glm::value_ptr(values[0]));
 	return true;
 }
@@ -282,6 +334,8 @@ bool ShaderInput::upload(std::size_t index, const Matrix4* values, std::size_t c
 	if (uniformLocation == -1)
 		return false;
 	
+	forgetUploadedVersion();
+	
 	glUniformMatrix4fv(uniformLocation + index * 4, static_cast<GLsizei>(count), GL_FALSE, glm::value_ptr(values[0]));
 	return true;
 }
@@ -294,8 +348,7 @@ bool ShaderInput::upload(std::size_t index, const Texture2D** values, std::size_
 	for (std::size_t i = 0; i < count; ++i)
 	{
 		// Bind texture to a texture unit reserved by this shader input
-		glActiveTexture(GL_TEXTURE0 + textureUnit + index + i);
-		glBindTexture(GL_TEXTURE_2D, values[i]->getTextureID());
+		GLState::bindTexture(textureUnit + index + i, GL_TEXTURE_2D, values[i]->getTextureID());
 		
 		// Upload texture unit index to shader
 		glUniform1i(uniformLocation + index + i, textureUnit + index + i);
@@ -312,8 +365,7 @@ bool ShaderInput::upload(std::size_t index, const TextureCube** values, std::siz
 	for (std::size_t i = 0; i < count; ++i)
 	{
 		// Bind texture to a texture unit reserved by this shader input
-		glActiveTexture(GL_TEXTURE0 + textureUnit + index + i);
-		glBindTexture(GL_TEXTURE_CUBE_MAP, values[i]->getTextureID());
+		GLState::bindTexture(textureUnit + index + i, GL_TEXTURE_CUBE_MAP, values[i]->getTextureID());
 		
 		// Upload texture unit index to shader
 		glUniform1i(uniformLocation + index + i, textureUnit + index + i);
@@ -23,8 +23,11 @@
 namespace Emergent
 {
 
+std::uint64_t ShaderVariableBase::versionCounter = 0;
+
 ShaderVariableBase::ShaderVariableBase():
-	connectedInput(nullptr)
+	connectedInput(nullptr),
+	version(++versionCounter)
 {}
 
 ShaderVariableBase::~ShaderVariableBase()
@@ -18,9 +18,11 @@
  */
 
 #include <emergent/graphics/shader.hpp>
+#include <emergent/graphics/gl-state.hpp>
 #include <emergent/graphics/material.hpp>
 #include <emergent/graphics/shader-variable.hpp>
 #include <emergent/graphics/shader-input.hpp>
+#include <emergent/graphics/uniform-buffer.hpp>
 #include <algorithm>
 #include <fstream>
 #include <iostream>
@@ -58,7 +60,7 @@ ShaderPermutation::~ShaderPermutation()
 		glDeleteShader(fragmentShader);
 	}
 	
-	glDeleteProgram(shaderProgram);
+	GLState::deleteProgram(shaderProgram);
 }
 
 Shader::Shader():
@@ -254,13 +256,16 @@ bool Shader::generatePermutation(std::uint32_t permutation)
 	for (std::size_t i = 0; i < inputs.size(); ++i)
 	{
 		shaderPermutation->uniformLocations.push_back(-1);
+		shaderPermutation->uploadedVersions.push_back(0);
 	}
 	
 	// Insert shader permutation into map
 	permutations.insert(std::pair<std::uint32_t, ShaderPermutation*>(permutation, shaderPermutation));
 	
-	// Re-evaluate shader inputs
+	// Re-evaluate shader inputs, and point any new inputs to the active permutation's uniform locations
 	reevaluateInputs(shaderPermutation);
+	rerouteInputs();
+	bindUniformBlocks(shaderPermutation);
 
 	// Reconnect the shader variables of each linked materials
 	reconnectLinkedMaterials();
@@ -293,12 +298,15 @@ bool Shader::activate(std::uint32_t permutation)
 		return false;
 	}
 	
-	// Bind shader permutation and set as active permutation
-	activePermutation = it->second;
-	glUseProgram(activePermutation->shaderProgram);
+	// Bind shader permutation
+	GLState::useProgram(it->second->shaderProgram);
 	
-	// Reroute shader inputs to point to the active permutation's uniform locations.
-	rerouteInputs();
+	// Set as active permutation and reroute shader inputs to point to its uniform locations, unless it is already active
+	if (activePermutation != it->second)
+	{
+		activePermutation = it->second;
+		rerouteInputs();
+	}
 	
 	return true;
 }
@@ -431,6 +439,14 @@ void Shader::reevaluateInputs(ShaderPermutation* permutation)
 		GLenum uniformType;
 		glGetActiveUniform(permutation->shaderProgram, uniformIndex, static_cast<GLsizei>(maxUniformNameLength), &uniformNameLength, &uniformSize, &uniformType, &uniformName[0]);
 		
+		// Skip members of uniform blocks, which are read from uniform buffers rather than shader inputs
+		GLint blockIndex = -1;
+		glGetActiveUniformsiv(permutation->shaderProgram, 1, &uniformIndex, GL_UNIFORM_BLOCK_INDEX, &blockIndex);
+		if (blockIndex != -1)
+		{
+			continue;
+		}
+		
 		// Get name without array symbols
 		std::string inputName = uniformName;
 		std::size_t bracketPos = inputName.find_first_of("[");
@@ -541,6 +557,8 @@ void Shader::reevaluateInputs(ShaderPermutation* permutation)
 					// Permutation doesn't have this shader input
 					it2->second->uniformLocations.push_back(-1);
 				}
+				
+				it2->second->uploadedVersions.push_back(0);
 			}
 		}
 	}
@@ -549,6 +567,34 @@ void Shader::reevaluateInputs(ShaderPermutation* permutation)
 	delete[] uniformName;
 }
 
+void Shader::bindUniformBlocks(ShaderPermutation* permutation)
+{
+	// Get number of active uniform blocks in the shader
+	GLint activeBlockCount = 0;
+	glGetProgramiv(permutation->shaderProgram, GL_ACTIVE_UNIFORM_BLOCKS, &activeBlockCount);
+	
+	for (GLuint blockIndex = 0; blockIndex < static_cast<GLuint>(activeBlockCount); ++blockIndex)
+	{
+		// Get block name
+		GLint blockNameLength = 0;
+		glGetActiveUniformBlockiv(permutation->shaderProgram, blockIndex, GL_UNIFORM_BLOCK_NAME_LENGTH, &blockNameLength);
+		std::string blockName(blockNameLength, '\0');
+		glGetActiveUniformBlockName(permutation->shaderProgram, blockIndex, blockNameLength, &blockNameLength, &blockName[0]);
+		blockName.resize(blockNameLength);
+		
+		// Bind block to the binding point of its uniform buffer
+		GLuint bindingPoint;
+		if (findUniformBlockBinding(blockName, &bindingPoint))
+		{
+			glUniformBlockBinding(permutation->shaderProgram, blockIndex, bindingPoint);
+		}
+		else
+		{
+			std::cerr << "Shader uniform block \"" << blockName << "\" has no uniform buffer. The block will not be bound." << std::endl;
+		}
+	}
+}
+
 void Shader::rerouteInputs()
 {
 	if (activePermutation != nullptr)
@@ -556,6 +602,7 @@ void Shader::rerouteInputs()
 		for (std::size_t i = 0; i < inputs.size(); ++i)
 		{
 			inputs[i]->uniformLocation = activePermutation->uniformLocations[i];
+			inputs[i]->uploadedVersion = &activePermutation->uploadedVersions[i];
 		}
 	}
 	else
@@ -563,6 +610,7 @@ void Shader::rerouteInputs()
 		for (std::size_t i = 0; i < inputs.size(); ++i)
 		{
 			inputs[i]->uniformLocation = -1;
+			inputs[i]->uploadedVersion = nullptr;
 		}
 	}
 }
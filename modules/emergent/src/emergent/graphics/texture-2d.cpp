@@ -18,6 +18,7 @@
  */
 
 #include <emergent/graphics/texture-2d.hpp>
+#include <emergent/graphics/gl-state.hpp>
 
 namespace Emergent
 {
@@ -37,7 +38,7 @@ void Texture2D::destroy()
 {
 	if (textureID != 0)
 	{
-		glDeleteTextures(1, &textureID);
+		GLState::deleteTexture(textureID);
 		
 		textureID = 0;
 		width = 0;
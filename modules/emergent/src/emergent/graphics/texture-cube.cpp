@@ -18,6 +18,7 @@
  */
 
 #include <emergent/graphics/texture-cube.hpp>
+#include <emergent/graphics/gl-state.hpp>
 
 namespace Emergent
 {
@@ -36,7 +37,7 @@ void TextureCube::destroy()
 {
 	if (textureID != 0)
 	{
-		glDeleteTextures(1, &textureID);
+		GLState::deleteTexture(textureID);
 		
 		textureID = 0;
 		faceSize = 0;
@@ -20,6 +20,7 @@
 #include <emergent/graphics/texture-loader.hpp>
 #include <emergent/graphics/texture-2d.hpp>
 #include <emergent/graphics/texture-cube.hpp>
+#include <emergent/graphics/gl-state.hpp>
 #include <stb/stb_image.h>
 #include <algorithm>
 #include <cmath>
@@ -162,7 +163,7 @@ Texture2D* TextureLoader::load2D(const std::string& filename)
 	// Generate OpenGL texture ID
 	GLuint textureID;
 	glGenTextures(1, &textureID);
-	glBindTexture(GL_TEXTURE_2D, textureID);
+	GLState::bindTexture(0, GL_TEXTURE_2D, textureID);
 	
 	// Set wrapping and filtering parameters
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, (wrapRepeatS) ? GL_REPEAT : GL_CLAMP_TO_EDGE);
@@ -208,7 +209,7 @@ TextureCube* TextureLoader::loadCube(const std::string& filename)
 	// Generate OpenGL texture ID
 	GLuint textureID;
 	glGenTextures(1, &textureID);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
+	GLState::bindTexture(0, GL_TEXTURE_CUBE_MAP, textureID);
 	
 	// Set wrapping and filtering parameters
 	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, (wrapRepeatS) ? GL_REPEAT : GL_CLAMP_TO_EDGE);
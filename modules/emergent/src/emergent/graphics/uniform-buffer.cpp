@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2017-2019  Christopher J. Howard
+ *
+ * This file is part of Emergent.
+ *
+ * Emergent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Emergent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Emergent.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <emergent/graphics/uniform-buffer.hpp>
+#include <emergent/graphics/gl-state.hpp>
+
+namespace Emergent
+{
+
+// Matrices and 4-component vectors need no padding under the std140 rules, so the blocks can be copied as they are
+static_assert(sizeof(CameraBlock) == 6 * 64 + 2 * 16, "CameraBlock does not match its std140 layout");
+static_assert(sizeof(LightBlock) == 16 + (3 * LightBlock::maxPointLights + 2 * LightBlock::maxDirectionalLights + 4 * LightBlock::maxSpotlights) * 16, "LightBlock does not match its std140 layout");
+
+UniformBuffer::UniformBuffer(GLuint bindingPoint):
+	bindingPoint(bindingPoint),
+	buffer(0)
+{}
+
+UniformBuffer::~UniformBuffer()
+{
+	if (buffer != 0)
+	{
+		GLState::deleteBuffer(buffer);
+	}
+}
+
+void UniformBuffer::update(const void* data, std::size_t size)
+{
+	if (buffer == 0)
+	{
+		glGenBuffers(1, &buffer);
+	}
+	
+	// Respecifying the whole store lets the driver hand out fresh memory instead of waiting for draws which still read the previous contents
+	GLState::bindBuffer(GL_UNIFORM_BUFFER, buffer);
+	glBufferData(GL_UNIFORM_BUFFER, static_cast<GLsizeiptr>(size), data, GL_STREAM_DRAW);
+	
+	bind();
+}
+
+void UniformBuffer::bind() const
+{
+	if (buffer != 0)
+	{
+		GLState::bindBufferBase(GL_UNIFORM_BUFFER, bindingPoint, buffer);
+	}
+}
+
+bool findUniformBlockBinding(const std::string& blockName, GLuint* bindingPoint)
+{
+	if (blockName == "CameraBlock")
+	{
+		*bindingPoint = CameraBlock::bindingPoint;
+		return true;
+	}
+	else if (blockName == "LightBlock")
+	{
+		*bindingPoint = LightBlock::bindingPoint;
+		return true;
+	}
+	
+	return false;
+}
+
+} // namespace Emergent
+
@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2017-2019  Christopher J. Howard
+ *
+ * This file is part of Emergent.
+ *
+ * Emergent is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Emergent is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Emergent.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <emergent/utility/mapped-file.hpp>
+
+#if defined(_WIN32)
+	#define WIN32_LEAN_AND_MEAN
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+namespace Emergent
+{
+
+MappedFile::MappedFile():
+	data(nullptr),
+	size(0)
+{}
+
+MappedFile::~MappedFile()
+{
+	close();
+}
+
+bool MappedFile::open(const std::string& filename)
+{
+	close();
+	
+#if defined(_WIN32)
+	HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+	
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+	{
+		CloseHandle(file);
+		return false;
+	}
+	
+	// The view keeps the mapping and file open until it is unmapped
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	CloseHandle(file);
+	if (mapping == nullptr)
+	{
+		return false;
+	}
+	
+	void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(mapping);
+	if (view == nullptr)
+	{
+		return false;
+	}
+	
+	data = view;
+	size = static_cast<std::size_t>(fileSize.QuadPart);
+#else
+	int descriptor = ::open(filename.c_str(), O_RDONLY);
+	if (descriptor == -1)
+	{
+		return false;
+	}
+	
+	struct stat status;
+	if (fstat(descriptor, &status) == -1 || status.st_size == 0)
+	{
+		::close(descriptor);
+		return false;
+	}
+	
+	// The mapping remains valid after the file descriptor is closed
+	void* view = mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_PRIVATE, descriptor, 0);
+	::close(descriptor);
+	if (view == MAP_FAILED)
+	{
+		return false;
+	}
+	
+	data = view;
+	size = static_cast<std::size_t>(status.st_size);
+#endif
+	
+	return true;
+}
+
+void MappedFile::close()
+{
+	if (data == nullptr)
+	{
+		return;
+	}
+	
+#if defined(_WIN32)
+	UnmapViewOfFile(data);
+#else
+	munmap(const_cast<void*>(data), size);
+#endif
+	
+	data = nullptr;
+	size = 0;
+}
+
+} // namespace Emergent
+